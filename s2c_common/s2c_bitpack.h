@@ -0,0 +1,118 @@
+/*
+ * s2c_bitpack.h
+ *
+ * Created: 2026-10-19 3:48:10 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_BITPACK_H_
+#define S2C_BITPACK_H_
+
+/*
+ * Bit-packed CAN payloads.
+ *
+ * Signals are unsigned, 1 to 16 bits wide, and start at any bit offset. Bit
+ * numbering is little endian (Intel, DBC "@1+"): bit 0 is the LSB of byte 0,
+ * bit 8 the LSB of byte 1, and a signal's LSB sits at its start bit. This is
+ * the same byte order as convert_16_bit_to_byte_array().
+ *
+ * Only standard C is used, so the central module / host tools can include this
+ * header to decode with the same layouts.
+ */
+
+struct s2c_bitpack_signal {
+	uint8_t offset;	// start bit
+	uint8_t width;	// bits
+};
+
+/*
+ * Frame 1 layouts of each board type. Values wider than their signal saturate.
+ */
+// suspension (10-bit ADC counts), brake temperature (deg C, 0 to 4095), wheel speed (0.1 km/h)
+#define S2C_WHEEL_FRAME_LAYOUT		{ { 0, 10 }, { 10, 12 }, { 22, 12 } }
+// outer, middle, inner tire temperature (MLX90614 raw, 0.02 K per count)
+#define S2C_TIRE_TEMP_FRAME_LAYOUT	{ { 0, 15 }, { 15, 15 }, { 30, 15 } }
+// radiator inlet, outlet (0.01 deg C, offset -40 deg C, see s2c_thermistor.h)
+#define S2C_RADIATOR_FRAME_LAYOUT	{ { 0, 15 }, { 15, 15 } }
+
+/*
+ * Returns the number of payload bytes needed for a layout
+ */
+static inline uint8_t s2c_bitpack_length(const struct s2c_bitpack_signal *layout, uint8_t num_signals) {
+	uint8_t bits = 0;
+	for(uint8_t i = 0; i < num_signals; i++) {
+		if(layout[i].offset + layout[i].width > bits) {
+			bits = layout[i].offset + layout[i].width;
+		}
+	}
+	return (bits + 7) / 8;
+}
+
+/*
+ * Writes value into buf at the signal's bits. Other bits of buf are left alone.
+ */
+static inline void s2c_bitpack_put(uint8_t *buf, struct s2c_bitpack_signal signal, uint16_t value) {
+	uint16_t max = (1UL << signal.width) - 1;
+	if(value > max) value = max;
+
+	uint8_t bit = signal.offset;
+	uint8_t remaining = signal.width;
+	while(remaining > 0) {
+		uint8_t shift = bit % 8;
+		uint8_t chunk = (8 - shift < remaining) ? 8 - shift : remaining;
+		uint8_t mask = ((1U << chunk) - 1) << shift;
+
+		buf[bit / 8] = (buf[bit / 8] & ~mask) | ((value << shift) & mask);
+
+		value >>= chunk;
+		bit += chunk;
+		remaining -= chunk;
+	}
+}
+
+/*
+ * Reads the signal's value back out of buf
+ */
+static inline uint16_t s2c_bitpack_get(const uint8_t *buf, struct s2c_bitpack_signal signal) {
+	uint16_t value = 0;
+	uint8_t bit = signal.offset;
+	uint8_t done = 0;
+	while(done < signal.width) {
+		uint8_t shift = bit % 8;
+		uint8_t chunk = (8 - shift < signal.width - done) ? 8 - shift : signal.width - done;
+
+		value |= (uint16_t)((buf[bit / 8] >> shift) & ((1U << chunk) - 1)) << done;
+
+		bit += chunk;
+		done += chunk;
+	}
+	return value;
+}
+
+/*
+ * Packs num_signals values into buf (cleared first) and returns the payload length
+ */
+static inline uint8_t s2c_bitpack_encode(uint8_t *buf, const struct s2c_bitpack_signal *layout,
+		const uint16_t *vals, uint8_t num_signals) {
+	uint8_t len = s2c_bitpack_length(layout, num_signals);
+	for(uint8_t i = 0; i < len; i++) {
+		buf[i] = 0;
+	}
+	for(uint8_t i = 0; i < num_signals; i++) {
+		s2c_bitpack_put(buf, layout[i], vals[i]);
+	}
+	return len;
+}
+
+/*
+ * Host side counterpart of s2c_bitpack_encode()
+ */
+static inline void s2c_bitpack_decode(const uint8_t *buf, const struct s2c_bitpack_signal *layout,
+		uint16_t *vals, uint8_t num_signals) {
+	for(uint8_t i = 0; i < num_signals; i++) {
+		vals[i] = s2c_bitpack_get(buf, layout[i]);
+	}
+}
+
+#endif /* S2C_BITPACK_H_ */
@@ -0,0 +1,73 @@
+/*
+ * s2c_can_timing.h
+ *
+ * Created: 2026-10-19 9:31:05 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_CAN_TIMING_H_
+#define S2C_CAN_TIMING_H_
+
+/*
+ * Compile-time CAN bit timing.
+ *
+ * A bit is one sync time quantum (tq), TSEG1 before the sample point and
+ * TSEG2 after it. For a CAN clock, bitrate and sample point (per mille) these
+ * macros pick the smallest prescaler, up to 32, that gives a whole number of
+ * time quanta per bit in [min_tq, max_tq], then place the sample point as
+ * close to the target as the quanta allow. SJW is as wide as TSEG2 allows.
+ *
+ * Everything is a constant expression of its arguments, so a configuration
+ * can be checked with S2C_CAN_TIMING_VALID() in a _Static_assert. Lengths
+ * are in time quanta, registers usually take them minus 1.
+ *
+ * Only standard C is used, so host tools can include this header too.
+ */
+
+// How far the real sample point may be from the target, per mille
+#define S2C_CAN_SAMPLE_POINT_TOLERANCE	20
+
+#define _S2C_CAN_FITS(clk, rate, brp, min_tq, max_tq) \
+	((clk) % ((brp) * (rate)) == 0 && \
+	(clk) / ((brp) * (rate)) >= (min_tq) && (clk) / ((brp) * (rate)) <= (max_tq))
+#define _S2C_CAN_TRY(clk, rate, brp, min_tq, max_tq, next) \
+	(_S2C_CAN_FITS(clk, rate, brp, min_tq, max_tq) ? (brp) : (next))
+#define _S2C_CAN_TRY4(clk, rate, brp, min_tq, max_tq, next) \
+	_S2C_CAN_TRY(clk, rate, (brp), min_tq, max_tq, \
+	_S2C_CAN_TRY(clk, rate, (brp) + 1, min_tq, max_tq, \
+	_S2C_CAN_TRY(clk, rate, (brp) + 2, min_tq, max_tq, \
+	_S2C_CAN_TRY(clk, rate, (brp) + 3, min_tq, max_tq, next))))
+
+/*
+ * Prescaler, 1 to 32, or 0 if the bitrate can't be reached from clk
+ */
+#define S2C_CAN_BRP(clk, rate, min_tq, max_tq) \
+	_S2C_CAN_TRY4(clk, rate, 1, min_tq, max_tq, \
+	_S2C_CAN_TRY4(clk, rate, 5, min_tq, max_tq, \
+	_S2C_CAN_TRY4(clk, rate, 9, min_tq, max_tq, \
+	_S2C_CAN_TRY4(clk, rate, 13, min_tq, max_tq, \
+	_S2C_CAN_TRY4(clk, rate, 17, min_tq, max_tq, \
+	_S2C_CAN_TRY4(clk, rate, 21, min_tq, max_tq, \
+	_S2C_CAN_TRY4(clk, rate, 25, min_tq, max_tq, \
+	_S2C_CAN_TRY4(clk, rate, 29, min_tq, max_tq, 0))))))))
+
+// Time quanta per bit for a prescaler from S2C_CAN_BRP(), 0 if there was none
+#define S2C_CAN_TQ(clk, rate, brp)		((brp) ? (clk) / ((brp) * (rate)) : 0)
+#define S2C_CAN_TSEG1(tq, sp)			(((tq) * (sp) + 500) / 1000 - 1)
+#define S2C_CAN_TSEG2(tq, sp)			((tq) - 1 - S2C_CAN_TSEG1(tq, sp))
+#define S2C_CAN_SJW(tq, sp, max_sjw)	((S2C_CAN_TSEG2(tq, sp) < (max_sjw)) ? S2C_CAN_TSEG2(tq, sp) : (max_sjw))
+// Sample point actually reached, per mille
+#define S2C_CAN_SAMPLE_POINT(tq, sp)	((tq) ? 1000 * (1 + S2C_CAN_TSEG1(tq, sp)) / (tq) : 0)
+
+/*
+ * True if the timing exists, fits the segment fields and hits the sample point
+ */
+#define S2C_CAN_TIMING_VALID(tq, sp, max_tseg1, max_tseg2) \
+	((tq) > 0 && \
+	S2C_CAN_TSEG1(tq, sp) >= 1 && S2C_CAN_TSEG1(tq, sp) <= (max_tseg1) && \
+	S2C_CAN_TSEG2(tq, sp) >= 1 && S2C_CAN_TSEG2(tq, sp) <= (max_tseg2) && \
+	S2C_CAN_SAMPLE_POINT(tq, sp) + S2C_CAN_SAMPLE_POINT_TOLERANCE >= (sp) && \
+	S2C_CAN_SAMPLE_POINT(tq, sp) <= (sp) + S2C_CAN_SAMPLE_POINT_TOLERANCE)
+
+#endif /* S2C_CAN_TIMING_H_ */
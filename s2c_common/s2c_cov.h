@@ -0,0 +1,56 @@
+/*
+ * s2c_cov.h
+ *
+ * Created: 2026-10-19 1:07:22 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_COV_H_
+#define S2C_COV_H_
+
+/*
+ * Change-of-value transmission policy.
+ *
+ * A frame is sent when any of its signals has moved by more than that signal's
+ * deadband since the last time the frame was sent, or when heartbeat_ms
+ * have passed without sending (keep-alive). A deadband of
+ * COV_DEADBAND_ALWAYS sends the frame every loop, for fast channels.
+ */
+
+#define COV_MAX_SIGNALS			4
+#define COV_DEADBAND_ALWAYS		0
+
+struct s2c_cov_state {
+	uint16_t last_sent[COV_MAX_SIGNALS];	// signal values in the last frame that was sent
+	uint16_t ms_since_sent;
+	bool sent_once;
+};
+
+/*
+ * Returns true if the frame should be sent this loop. Records the values as sent if so.
+ * elapsed_ms is the time since the previous call.
+ */
+static inline bool s2c_cov_update(struct s2c_cov_state *state, const uint16_t *vals, const uint16_t *deadband,
+		uint8_t num_signals, uint16_t elapsed_ms, uint16_t heartbeat_ms) {
+	state->ms_since_sent += elapsed_ms;
+	bool send = !state->sent_once || state->ms_since_sent >= heartbeat_ms;
+
+	for(uint8_t i = 0; i < num_signals && !send; i++) {
+		uint16_t diff = (vals[i] > state->last_sent[i]) ? vals[i] - state->last_sent[i] : state->last_sent[i] - vals[i];
+		if(deadband[i] == COV_DEADBAND_ALWAYS || diff > deadband[i]) {
+			send = true;
+		}
+	}
+
+	if(send) {
+		for(uint8_t i = 0; i < num_signals; i++) {
+			state->last_sent[i] = vals[i];
+		}
+		state->ms_since_sent = 0;
+		state->sent_once = true;
+	}
+	return send;
+}
+
+#endif /* S2C_COV_H_ */
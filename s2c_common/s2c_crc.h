@@ -0,0 +1,28 @@
+/*
+ * s2c_crc.h
+ *
+ * Created: 2026-10-19 10:24:50 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_CRC_H_
+#define S2C_CRC_H_
+
+/*
+ * CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection,
+ * no final XOR. Bitwise, so no table in flash, and standard C only, so host
+ * tools can check records with the same code.
+ */
+static inline uint16_t s2c_crc16(const uint8_t *data, uint16_t length) {
+	uint16_t crc = 0xFFFF;
+	while(length--) {
+		crc ^= (uint16_t)(*data++) << 8;
+		for(uint8_t bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+#endif /* S2C_CRC_H_ */
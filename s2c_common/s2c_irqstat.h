@@ -0,0 +1,65 @@
+/*
+ * s2c_irqstat.h
+ *
+ * Created: 2026-10-19 6:03:52 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_IRQSTAT_H_
+#define S2C_IRQSTAT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Interrupt latency and duration statistics.
+ *
+ * Times are read from a down-counter that counts from reload to 0 and then
+ * starts at reload again (SysTick on the sensor module). Nothing here touches
+ * hardware, so host tools can feed simulated counter readings through the
+ * same code.
+ */
+
+struct s2c_irqstat {
+	uint32_t count;			// handler runs
+	uint32_t min_latency;	// cycles from the interrupt firing to handler entry, UINT32_MAX until one is recorded
+	uint32_t max_latency;	// 0 until one is recorded
+	uint32_t max_duration;	// cycles from handler entry to exit, including any preemption
+};
+
+static inline void s2c_irqstat_reset(struct s2c_irqstat *stat) {
+	stat->count = 0;
+	stat->min_latency = UINT32_MAX;
+	stat->max_latency = 0;
+	stat->max_duration = 0;
+}
+
+/*
+ * Cycles from reading from to reading to. Only correct if less than one
+ * counter period (reload + 1 cycles) passed in between.
+ */
+static inline uint32_t s2c_irqstat_elapsed(uint32_t from, uint32_t to, uint32_t reload) {
+	return (from >= to) ? from - to : from + (reload + 1) - to;
+}
+
+static inline void s2c_irqstat_record(struct s2c_irqstat *stat, uint32_t latency, uint32_t duration) {
+	++stat->count;
+	if(latency < stat->min_latency) stat->min_latency = latency;
+	if(latency > stat->max_latency) stat->max_latency = latency;
+	if(duration > stat->max_duration) stat->max_duration = duration;
+}
+
+/*
+ * For handlers that can't tell when their interrupt fired, the latency stays unrecorded
+ */
+static inline void s2c_irqstat_record_duration(struct s2c_irqstat *stat, uint32_t duration) {
+	++stat->count;
+	if(duration > stat->max_duration) stat->max_duration = duration;
+}
+
+static inline bool s2c_irqstat_has_latency(const struct s2c_irqstat *stat) {
+	return stat->min_latency <= stat->max_latency;
+}
+
+#endif /* S2C_IRQSTAT_H_ */
@@ -0,0 +1,78 @@
+/*
+ * s2c_rate.h
+ *
+ * Created: 2026-10-19 2:15:48 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_RATE_H_
+#define S2C_RATE_H_
+
+/*
+ * Adaptive loop rate.
+ *
+ * Keeps an exponentially weighted running mean and variance of one signal
+ * (weight 1 / 2^RATE_EWMA_SHIFT per sample) and steps through
+ * RATE_LOOP_PERIODS_MS: one level faster when the variance goes above
+ * RATE_VARIANCE_HIGH, one level slower when it drops below RATE_VARIANCE_LOW.
+ * A level is held for at least RATE_HOLD_LOOPS loops so the rate doesn't
+ * chatter. The loop period sets both the ADC sample rate and the CAN rate.
+ */
+
+#define RATE_NUM_LEVELS			4
+#define RATE_LOOP_PERIODS_MS	{ 40, 20, 10, 5 } // slowest to fastest
+#define RATE_DEFAULT_LEVEL		1
+#define RATE_EWMA_SHIFT			3
+#define RATE_VARIANCE_HIGH		64	// ADC counts^2, i.e. ~8 counts standard deviation
+#define RATE_VARIANCE_LOW		16	// ADC counts^2, i.e. ~4 counts standard deviation
+#define RATE_HOLD_LOOPS			25
+
+struct s2c_rate_state {
+	int32_t mean;		// running mean, scaled by 2^RATE_EWMA_SHIFT
+	uint32_t variance;	// running variance, ADC counts^2
+	uint8_t level;
+	uint16_t hold;
+	bool primed;
+};
+
+static inline void s2c_rate_init(struct s2c_rate_state *state) {
+	state->mean = 0;
+	state->variance = 0;
+	state->level = RATE_DEFAULT_LEVEL;
+	state->hold = 0;
+	state->primed = false;
+}
+
+/*
+ * Feeds one sample in and returns the loop period to use, in ms.
+ */
+static inline uint16_t s2c_rate_update(struct s2c_rate_state *state, uint16_t sample) {
+	static const uint16_t periods_ms[RATE_NUM_LEVELS] = RATE_LOOP_PERIODS_MS;
+
+	if(!state->primed) {
+		state->mean = (int32_t)sample << RATE_EWMA_SHIFT;
+		state->primed = true;
+	}
+
+	// Incremental EWMA mean and variance, all integer
+	int32_t diff = ((int32_t)sample << RATE_EWMA_SHIFT) - state->mean;
+	state->mean += diff >> RATE_EWMA_SHIFT;
+	diff >>= RATE_EWMA_SHIFT;
+	uint32_t sq = (uint32_t)(diff * diff);
+	state->variance = state->variance - (state->variance >> RATE_EWMA_SHIFT) + (sq >> RATE_EWMA_SHIFT);
+
+	if(state->hold > 0) {
+		--state->hold;
+	} else if(state->variance > RATE_VARIANCE_HIGH && state->level < RATE_NUM_LEVELS - 1) {
+		++state->level;
+		state->hold = RATE_HOLD_LOOPS;
+	} else if(state->variance < RATE_VARIANCE_LOW && state->level > 0) {
+		--state->level;
+		state->hold = RATE_HOLD_LOOPS;
+	}
+
+	return periods_ms[state->level];
+}
+
+#endif /* S2C_RATE_H_ */
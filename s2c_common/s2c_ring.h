@@ -0,0 +1,131 @@
+/*
+ * s2c_ring.h
+ *
+ * Created: 2026-10-19 5:12:40 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_RING_H_
+#define S2C_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Lock-free single-producer/single-consumer ring of fixed-size slots.
+ *
+ * Meant for handing data from one interrupt handler (producer) to the main
+ * loop (consumer) without disabling interrupts. head is only ever written by
+ * the producer and tail only by the consumer, both as single aligned 16-bit
+ * stores, which are atomic on the Cortex-M0+. A memory barrier orders the
+ * slot contents against the index update on both sides.
+ *
+ * Slots are used in place: the producer fills the slot returned by
+ * s2c_ring_write_slot() and publishes it with s2c_ring_commit(), the consumer
+ * reads the slot returned by s2c_ring_read_slot() and frees it with
+ * s2c_ring_release(). s2c_ring_push() / s2c_ring_pop() copy whole slots for
+ * small records. When the ring is full the producer gets no slot, it never
+ * waits and never overwrites data the consumer hasn't released.
+ *
+ * The number of slots must be a power of 2, at most 32768.
+ */
+
+#ifndef S2C_RING_BARRIER
+#  if defined(__arm__)
+#    define S2C_RING_BARRIER()	__asm volatile ("dmb" ::: "memory")
+#  else
+#    define S2C_RING_BARRIER()	__sync_synchronize()
+#  endif
+#endif
+
+struct s2c_ring {
+	uint8_t *data;
+	uint16_t slot_size;		// bytes
+	uint16_t mask;			// number of slots - 1
+	volatile uint16_t head;	// free running count of committed slots, producer only
+	volatile uint16_t tail;	// free running count of released slots, consumer only
+};
+
+/*
+ * storage must hold num_slots * slot_size bytes
+ */
+static inline void s2c_ring_init(struct s2c_ring *ring, void *storage, uint16_t slot_size, uint16_t num_slots) {
+	ring->data = (uint8_t *)storage;
+	ring->slot_size = slot_size;
+	ring->mask = num_slots - 1;
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+/*
+ * Number of committed slots that haven't been released yet
+ */
+static inline uint16_t s2c_ring_count(const struct s2c_ring *ring) {
+	return (uint16_t)(ring->head - ring->tail);
+}
+
+/*
+ * Producer: returns the next free slot to fill, or NULL if the ring is full
+ */
+static inline void *s2c_ring_write_slot(struct s2c_ring *ring) {
+	uint16_t head = ring->head;
+	if((uint16_t)(head - ring->tail) > ring->mask) return NULL;
+	S2C_RING_BARRIER(); // don't touch the slot before seeing the consumer has released it
+	return ring->data + (uint32_t)(head & ring->mask) * ring->slot_size;
+}
+
+/*
+ * Producer: publishes the slot returned by s2c_ring_write_slot()
+ */
+static inline void s2c_ring_commit(struct s2c_ring *ring) {
+	S2C_RING_BARRIER(); // slot contents must land before the consumer can see the new head
+	ring->head = ring->head + 1;
+}
+
+/*
+ * Consumer: returns the oldest committed slot, or NULL if the ring is empty
+ */
+static inline void *s2c_ring_read_slot(struct s2c_ring *ring) {
+	uint16_t tail = ring->tail;
+	if(ring->head == tail) return NULL;
+	S2C_RING_BARRIER(); // don't read the slot before seeing the producer has committed it
+	return ring->data + (uint32_t)(tail & ring->mask) * ring->slot_size;
+}
+
+/*
+ * Consumer: hands the slot returned by s2c_ring_read_slot() back to the producer
+ */
+static inline void s2c_ring_release(struct s2c_ring *ring) {
+	S2C_RING_BARRIER(); // finish reading the slot before the producer may reuse it
+	ring->tail = ring->tail + 1;
+}
+
+/*
+ * Producer: copies one slot in. Returns false (and drops it) if the ring is full
+ */
+static inline bool s2c_ring_push(struct s2c_ring *ring, const void *slot) {
+	uint8_t *dst = (uint8_t *)s2c_ring_write_slot(ring);
+	if(dst == NULL) return false;
+	for(uint16_t i = 0; i < ring->slot_size; i++) {
+		dst[i] = ((const uint8_t *)slot)[i];
+	}
+	s2c_ring_commit(ring);
+	return true;
+}
+
+/*
+ * Consumer: copies the oldest slot out. Returns false if the ring is empty
+ */
+static inline bool s2c_ring_pop(struct s2c_ring *ring, void *slot) {
+	const uint8_t *src = (const uint8_t *)s2c_ring_read_slot(ring);
+	if(src == NULL) return false;
+	for(uint16_t i = 0; i < ring->slot_size; i++) {
+		((uint8_t *)slot)[i] = src[i];
+	}
+	s2c_ring_release(ring);
+	return true;
+}
+
+#endif /* S2C_RING_H_ */
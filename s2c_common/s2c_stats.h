@@ -0,0 +1,80 @@
+/*
+ * s2c_stats.h
+ *
+ * Created: 2026-10-19 3:02:31 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_STATS_H_
+#define S2C_STATS_H_
+
+/*
+ * Incremental min/max/mean/RMS of one 16-bit signal over a window of up to
+ * 65535 samples, integer only. The only division and square root happen once
+ * per window, in s2c_stats_get().
+ */
+
+struct s2c_stats {
+	uint16_t min;
+	uint16_t max;
+	uint32_t sum;
+	uint64_t sum_sq;
+	uint16_t count;
+};
+
+struct s2c_stats_result {
+	uint16_t min;
+	uint16_t max;
+	uint16_t mean;
+	uint16_t rms;
+};
+
+static inline void s2c_stats_reset(struct s2c_stats *stats) {
+	stats->min = 0xFFFF;
+	stats->max = 0;
+	stats->sum = 0;
+	stats->sum_sq = 0;
+	stats->count = 0;
+}
+
+static inline void s2c_stats_add(struct s2c_stats *stats, uint16_t val) {
+	if(val < stats->min) stats->min = val;
+	if(val > stats->max) stats->max = val;
+	stats->sum += val;
+	stats->sum_sq += (uint32_t)val * val;
+	++stats->count;
+}
+
+/*
+ * Integer square root, rounded down (bit by bit, no division)
+ */
+static inline uint16_t s2c_isqrt(uint32_t x) {
+	uint32_t res = 0;
+	uint32_t bit = 1UL << 30;
+
+	while(bit > x) bit >>= 2;
+	while(bit != 0) {
+		if(x >= res + bit) {
+			x -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+	return res;
+}
+
+static inline void s2c_stats_get(const struct s2c_stats *stats, struct s2c_stats_result *result) {
+	if(stats->count == 0) {
+		result->min = result->max = result->mean = result->rms = 0;
+		return;
+	}
+	result->min = stats->min;
+	result->max = stats->max;
+	result->mean = stats->sum / stats->count;
+	result->rms = s2c_isqrt((uint32_t)(stats->sum_sq / stats->count));
+}
+
+#endif /* S2C_STATS_H_ */
@@ -0,0 +1,90 @@
+/*
+ * s2c_thermistor.h
+ *
+ * Created: 2026-10-19 11:21:36 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_THERMISTOR_H_
+#define S2C_THERMISTOR_H_
+
+/*
+ * NTC thermistor linearisation.
+ *
+ * The thermistor sits on the low side of a divider with a pull-up to the ADC
+ * reference, so a reading of count out of full scale means
+ * R = R_pullup * count / (full scale - count), and the beta model gives
+ * 1/T = 1/T25 + ln(R / R25) / beta.
+ *
+ * S2C_THERM_TABLE() works that out for S2C_THERM_SEGMENTS + 1 evenly spaced
+ * readings at compile time. GCC folds __builtin_log() of constants, so no
+ * float code or log() ends up on the chip, just the table. s2c_therm_lookup()
+ * interpolates linearly between entries: a shift, a mask and a multiply.
+ * With 64 segments on a 10-bit reading and a 10k/3435 part on a 10k pull-up
+ * the interpolation is within 0.3 deg C from 0 to 110 deg C, and within
+ * 0.6 deg C from -20 to 130 deg C.
+ *
+ * Results are in 0.01 deg C, clamped to S2C_THERM_CENTI_C_MIN..MAX, which is
+ * also where open and shorted sensors end up.
+ */
+
+#define S2C_THERM_SEGMENTS		64
+#define S2C_THERM_CENTI_C_MIN	(-4000)
+#define S2C_THERM_CENTI_C_MAX	28767 // MIN + 32767, so the offset value fits 15 bits
+
+// Reading clamped off the rails, where the divider has no finite answer
+#define _S2C_THERM_COUNT(i, full_scale) \
+	((i) * (full_scale) / S2C_THERM_SEGMENTS < 1 ? 1 : \
+	 (i) * (full_scale) / S2C_THERM_SEGMENTS > (full_scale) - 1 ? (full_scale) - 1 : \
+	 (i) * (full_scale) / S2C_THERM_SEGMENTS)
+#define _S2C_THERM_RAW(i, full_scale, beta, r25, r_pullup) \
+	(100.0 / (1.0 / 298.15 + __builtin_log((double)(r_pullup) * _S2C_THERM_COUNT(i, full_scale) / \
+		(((full_scale) - _S2C_THERM_COUNT(i, full_scale)) * (double)(r25))) / (beta)) - 27315.0)
+#define _S2C_THERM_ENTRY(i, full_scale, beta, r25, r_pullup) \
+	(int16_t)(_S2C_THERM_RAW(i, full_scale, beta, r25, r_pullup) < S2C_THERM_CENTI_C_MIN ? S2C_THERM_CENTI_C_MIN : \
+			  _S2C_THERM_RAW(i, full_scale, beta, r25, r_pullup) > S2C_THERM_CENTI_C_MAX ? S2C_THERM_CENTI_C_MAX : \
+			  __builtin_floor(_S2C_THERM_RAW(i, full_scale, beta, r25, r_pullup) + 0.5))
+#define _S2C_THERM_ROW(i, ...) \
+	_S2C_THERM_ENTRY((i) + 0, __VA_ARGS__), _S2C_THERM_ENTRY((i) + 1, __VA_ARGS__), \
+	_S2C_THERM_ENTRY((i) + 2, __VA_ARGS__), _S2C_THERM_ENTRY((i) + 3, __VA_ARGS__), \
+	_S2C_THERM_ENTRY((i) + 4, __VA_ARGS__), _S2C_THERM_ENTRY((i) + 5, __VA_ARGS__), \
+	_S2C_THERM_ENTRY((i) + 6, __VA_ARGS__), _S2C_THERM_ENTRY((i) + 7, __VA_ARGS__)
+
+/*
+ * Initialiser for a table of S2C_THERM_SEGMENTS + 1 int16_t, in 0.01 deg C
+ * full_scale:	ADC counts at the reference (1 << result bits)
+ * beta:		thermistor beta, K
+ * r25:			thermistor resistance at 25 deg C, ohm
+ * r_pullup:	divider pull-up, ohm
+ */
+#define S2C_THERM_TABLE(full_scale, beta, r25, r_pullup) { \
+	_S2C_THERM_ROW(0, full_scale, beta, r25, r_pullup), _S2C_THERM_ROW(8, full_scale, beta, r25, r_pullup), \
+	_S2C_THERM_ROW(16, full_scale, beta, r25, r_pullup), _S2C_THERM_ROW(24, full_scale, beta, r25, r_pullup), \
+	_S2C_THERM_ROW(32, full_scale, beta, r25, r_pullup), _S2C_THERM_ROW(40, full_scale, beta, r25, r_pullup), \
+	_S2C_THERM_ROW(48, full_scale, beta, r25, r_pullup), _S2C_THERM_ROW(56, full_scale, beta, r25, r_pullup), \
+	_S2C_THERM_ENTRY(64, full_scale, beta, r25, r_pullup) }
+
+_Static_assert(S2C_THERM_SEGMENTS == 64, "S2C_THERM_TABLE() is written out for 64 segments");
+
+/*
+ * The other way round, for thresholds: the reading at centi_c (0.01 deg C).
+ * Lower readings are hotter. Also folded by the compiler.
+ */
+#define S2C_THERM_COUNT(centi_c, full_scale, beta, r25, r_pullup) \
+	(uint16_t)((full_scale) / (1.0 + (double)(r_pullup) / ((double)(r25) * \
+		__builtin_exp((beta) * (1.0 / ((centi_c) / 100.0 + 273.15) - 1.0 / 298.15)))) + 0.5)
+
+/*
+ * Returns the temperature in 0.01 deg C for a reading of result_bits bits
+ */
+static inline int16_t s2c_therm_lookup(const int16_t *table, uint16_t count, uint8_t result_bits) {
+	uint8_t shift = result_bits - 6; // log2(S2C_THERM_SEGMENTS)
+	uint16_t index = count >> shift;
+	if(index >= S2C_THERM_SEGMENTS) return table[S2C_THERM_SEGMENTS];
+	
+	int32_t frac = count & ((1U << shift) - 1);
+	return table[index] + (((table[index + 1] - table[index]) * frac) >> shift);
+}
+
+#endif /* S2C_THERMISTOR_H_ */
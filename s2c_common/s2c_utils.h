@@ -9,6 +9,15 @@
 #ifndef S2C_UTILS_H_
 #define S2C_UTILS_H_
 
+#include <s2c_cov.h>
+#include <s2c_rate.h>
+#include <s2c_stats.h>
+#include <s2c_bitpack.h>
+#include <s2c_ring.h>
+#include <s2c_irqstat.h>
+#include <s2c_crc.h>
+#include <s2c_thermistor.h>
+
 // SENSE2CAN board types
 enum s2c_board_type {
 	/* S2C board mounted near wheels:
@@ -16,11 +25,23 @@ enum s2c_board_type {
 	 * --> suspension potentiometer
 	 * - 1 I2C slave:
 	 * --> brake temperature sensor
+	 * - 1 pulse input (USE_WHEEL_SPEED only, pulse input 0, see s2c_pulse.h):
+	 * --> wheel speed sensor
 	 * 
 	 * CAN setup:
-	 * - frame 1: 4 bytes
-	 * --> bytes 0 & 1: suspension potentiometer
-	 * --> bytes 2 & 3: brake temperature
+	 * - frame 1: 5 bytes, bit-packed (see S2C_WHEEL_FRAME_LAYOUT)
+	 * --> bits 0 to 9: suspension potentiometer
+	 * --> bits 10 to 21: brake temperature
+	 * --> bits 22 to 33: wheel speed (0.1 km/h, 0 without USE_WHEEL_SPEED)
+	 * - frame 2 (analysis mode only, once per analysis block): 8 bytes
+	 * --> bytes 0 & 1: body band energy (1-3 Hz)
+	 * --> bytes 2 & 3: mid band energy (3-10 Hz)
+	 * --> bytes 4 & 5: wheel hop band energy (10-20 Hz)
+	 * --> bytes 6 & 7: high band energy (20 Hz and up)
+	 * - frame 7 (filter mode only, drained after each sampler block): 2 to 8 bytes
+	 * --> see s2c_filter.h for the layout of the decimated samples
+	 * - frame 15 (capture mode only, drained after each event): 8 bytes
+	 * --> see s2c_capture.h for the header and data layout
 	 */
 	S2C_BOARD_WHEEL,
 	/* S2C board used for tire temperature bar:
@@ -30,37 +51,153 @@ enum s2c_board_type {
 	 * --> inner tire temp
 	 * 
 	 * CAN setup:
-	 * - frame 1: 6 bytes
-	 * --> bytes 0 & 1: outer tire temp
-	 * --> bytes 2 & 3: middle tire temp
-	 * --> bytes 4 & 5: inner tire temp
+	 * - frame 1: 6 bytes, bit-packed (see S2C_TIRE_TEMP_FRAME_LAYOUT), MLX90614 raw, 0.02 K per count
+	 * --> bits 0 to 14: outer tire temp
+	 * --> bits 15 to 29: middle tire temp
+	 * --> bits 30 to 44: inner tire temp
 	 */
 	S2C_BOARD_TIRE_TEMP,
 	/* S2C board mounted near radiator:
-	 * - 2 analog inputs:
+	 * - 2 analog inputs, NTC thermistors (see RADIATOR_THERM_*):
 	 * --> radiator inlet temperature
 	 * -- radiator outlet temperature
 	 * 
 	 * CAN setup:
-	 * - frame 1: 4 bytes
-	 * --> bytes 0 & 1: radiator inlet temperature
-	 * --> bytes 2 & 3: radiator outlet temperature
+	 * - frame 1: 4 bytes, bit-packed (see S2C_RADIATOR_FRAME_LAYOUT), 0.01 deg C from -40 deg C
+	 * --> bits 0 to 14: radiator inlet temperature
+	 * --> bits 15 to 29: radiator outlet temperature
+	 * - alarm frame (USE_RADIATOR_ALARM only): inlet above RADIATOR_ALARM_CENTI_C, see s2c_alarm.h
+	 * - summary mode: frames 5 & 6 replace frame 1, once per SUMMARY_WINDOW_MS: 8 bytes
+	 * --> bytes 0 & 1: minimum
+	 * --> bytes 2 & 3: maximum
+	 * --> bytes 4 & 5: mean
+	 * --> bytes 6 & 7: RMS
 	 */
 	S2C_BOARD_RADIATOR,
 	/* Any other S2C board use */
 	S2C_BOARD_OTHER
 };
 
+// CPU clock profiles, see s2c_clock.h
+enum s2c_clock_profile {
+	S2C_CLOCK_BALANCED,		// 16 MHz, the boot clock
+	S2C_CLOCK_LOW_POWER,	// 8 MHz
+	S2C_CLOCK_FULL_SPEED	// 48 MHz
+};
+
 // S2C configuration struct
 struct s2c_board_config {
 	bool use_adc;			// True if this configuration needs ADC
 	uint8_t adc_channels;	// Number of ADC inputs defined for this configuration
 	bool use_i2c;			// True if this configuration needs I2C
+	uint8_t pulse_mask;		// Bit n set if this configuration uses pulse input n, see s2c_pulse.h
+	int8_t alarm_channel;	// ADC channel the hardware alarm watches between scans, -1 for none, see s2c_alarm.h
+	bool alarm_below;		// True if the alarm trips below alarm_threshold, false if above
+	uint16_t alarm_threshold;	// ADC counts
+	bool use_filter;		// True if ADC channel 0 is sampled at SAMPLER_RATE_HZ, low-pass filtered and decimated
+	bool use_analysis;		// True if ADC channel 0 is sampled at SAMPLER_RATE_HZ for band energy analysis
+	bool use_capture;		// True if ADC channel 0 is captured around bump/curb strike events
+	uint16_t cov_deadband[COV_MAX_SIGNALS];	// Per-signal change needed to send frame 1, in frame units
+	uint16_t cov_heartbeat_ms;	// Frame 1 is sent at least this often
+	bool use_adaptive_rate;	// True if the loop rate follows the activity of ADC channel 0
+	bool use_summary;		// True if frame 1 is replaced by per-window min/max/mean/RMS frames
+	enum s2c_clock_profile clock_profile;	// CPU clock this configuration needs
 };
 
-#define S2C_BOARD_WHEEL_CONFIG(x)			{ x.use_adc = true; x.adc_channels = 1; x.use_i2c = true; }
-#define S2C_BOARD_TIRE_TEMP_CONFIG(x)		{ x.use_adc = false; x.adc_channels = 0; x.use_i2c = true; }
-#define S2C_BOARD_RADIATOR_CONFIG(x)		{ x.use_adc = true; x.adc_channels = 2; x.use_i2c = false; }
+// Windowed summaries on the radiator board. Off unless enabled in conf_board.h
+#ifndef USE_RADIATOR_SUMMARY
+#define USE_RADIATOR_SUMMARY	false
+#endif
+
+// Suspension band energy analysis on the wheel board. Off unless enabled in conf_board.h
+#ifndef USE_WHEEL_ANALYSIS
+#define USE_WHEEL_ANALYSIS	false
+#endif
+// Filtered and decimated suspension stream on the wheel board. Off unless enabled in conf_board.h
+#ifndef USE_WHEEL_FILTER
+#define USE_WHEEL_FILTER	false
+#endif
+// Event-triggered suspension capture on the wheel board. Off unless enabled in conf_board.h
+#ifndef USE_WHEEL_CAPTURE
+#define USE_WHEEL_CAPTURE	false
+#endif
+// Wheel speed from a toothed ring sensor on the wheel board. Off unless enabled in conf_board.h
+#ifndef USE_WHEEL_SPEED
+#define USE_WHEEL_SPEED		false
+#endif
+#ifndef WHEEL_SPEED_TEETH
+#define WHEEL_SPEED_TEETH			24
+#endif
+#ifndef WHEEL_CIRCUMFERENCE_MM
+#define WHEEL_CIRCUMFERENCE_MM		1600
+#endif
+// 0.1 km/h = WHEEL_SPEED_SCALE / period in us: 1 mm/us is 36000 * 0.1 km/h
+#define WHEEL_SPEED_SCALE			((WHEEL_CIRCUMFERENCE_MM * 36000UL + WHEEL_SPEED_TEETH / 2) / WHEEL_SPEED_TEETH)
+
+// Interrupt latency/duration debug frames, any board. Off unless enabled in conf_board.h
+#ifndef USE_IRQ_REPORT
+#define USE_IRQ_REPORT		false
+#endif
+
+// MTB branch trace for post-mortem dumps, any board. Off unless enabled in conf_board.h
+#ifndef USE_MTB_TRACE
+#define USE_MTB_TRACE		false
+#endif
+
+// CAN clocked from the crystal, any board with one fitted. Off unless enabled in conf_board.h
+#ifndef USE_XOSC_CAN_CLOCK
+#define USE_XOSC_CAN_CLOCK	false
+#endif
+
+// Radiator thermistors and their divider, set in conf_board.h to match the fitted parts
+#ifndef RADIATOR_THERM_BETA
+#define RADIATOR_THERM_BETA			3435
+#endif
+#ifndef RADIATOR_THERM_R25_OHM
+#define RADIATOR_THERM_R25_OHM		10000
+#endif
+#ifndef RADIATOR_THERM_PULLUP_OHM
+#define RADIATOR_THERM_PULLUP_OHM	10000
+#endif
+// Pulse inputs fitted to the radiator board, none unless set in conf_board.h
+#ifndef RADIATOR_PULSE_MASK
+#define RADIATOR_PULSE_MASK			0x0
+#endif
+// CAN loopback benchmark at boot, any board. Off unless enabled in conf_board.h
+#ifndef USE_CAN_BENCH
+#define USE_CAN_BENCH		false
+#endif
+
+// Coolant overtemperature alarm on the radiator inlet. Off unless enabled in conf_board.h
+#ifndef USE_RADIATOR_ALARM
+#define USE_RADIATOR_ALARM			false
+#endif
+#ifndef RADIATOR_ALARM_CENTI_C
+#define RADIATOR_ALARM_CENTI_C		11000
+#endif
+// NTC readings fall as it heats up, so the alarm trips below this
+#define RADIATOR_ALARM_COUNT		S2C_THERM_COUNT(RADIATOR_ALARM_CENTI_C, 1 << ADC_RESULT_BITS, RADIATOR_THERM_BETA, \
+										RADIATOR_THERM_R25_OHM, RADIATOR_THERM_PULLUP_OHM)
+
+#define S2C_BOARD_WHEEL_CONFIG(x)			{ x.use_adc = true; x.adc_channels = 1; x.use_i2c = true; \
+											  x.pulse_mask = USE_WHEEL_SPEED ? 0x1 : 0x0; x.alarm_channel = -1; \
+											  x.use_filter = USE_WHEEL_FILTER; x.use_analysis = USE_WHEEL_ANALYSIS; x.use_capture = USE_WHEEL_CAPTURE; \
+											  x.cov_deadband[0] = COV_DEADBAND_ALWAYS; x.cov_deadband[1] = 1; x.cov_deadband[2] = 5; \
+											  x.cov_heartbeat_ms = COV_HEARTBEAT_MS; x.use_adaptive_rate = true; x.use_summary = false; \
+											  x.clock_profile = S2C_CLOCK_FULL_SPEED; }
+#define S2C_BOARD_TIRE_TEMP_CONFIG(x)		{ x.use_adc = false; x.adc_channels = 0; x.use_i2c = true; \
+											  x.pulse_mask = 0x0; x.alarm_channel = -1; \
+											  x.use_filter = false; x.use_analysis = false; x.use_capture = false; \
+											  x.cov_deadband[0] = 25; x.cov_deadband[1] = 25; x.cov_deadband[2] = 25; \
+											  x.cov_heartbeat_ms = COV_HEARTBEAT_MS; x.use_adaptive_rate = false; x.use_summary = false; \
+											  x.clock_profile = S2C_CLOCK_LOW_POWER; }
+#define S2C_BOARD_RADIATOR_CONFIG(x)		{ x.use_adc = true; x.adc_channels = 2; x.use_i2c = false; \
+											  x.pulse_mask = RADIATOR_PULSE_MASK; x.alarm_channel = USE_RADIATOR_ALARM ? 0 : -1; \
+											  x.alarm_below = true; x.alarm_threshold = RADIATOR_ALARM_COUNT; \
+											  x.use_filter = false; x.use_analysis = false; x.use_capture = false; \
+											  x.cov_deadband[0] = 25; x.cov_deadband[1] = 25; \
+											  x.cov_heartbeat_ms = COV_HEARTBEAT_MS; x.use_adaptive_rate = false; x.use_summary = USE_RADIATOR_SUMMARY; \
+											  x.clock_profile = S2C_CLOCK_LOW_POWER; }
 
 /*
  * Returns board type based on the board ID.
@@ -95,12 +232,84 @@ static inline enum s2c_board_type get_board_type_from_id(uint8_t id) {
 
 // CAN stuff
 #define CAN_ID_BASE 0x700 // avoids clashing with potential bootloader messages
+#define CAN_ALARM_ID(id)		(0x080 + (id)) // alarm frames, ahead of all telemetry in arbitration, see s2c_alarm.h
 #define CAN_MSG_ID(id, msg_id)	 CAN_ID_BASE + (id << 4) + msg_id
+#define CAN_MSG_COMMAND			0x2 // configuration commands to the module, see s2c_nvm.h
+#define CAN_MSG_COMMAND_REPLY	0x3
+#define CAN_MSG_SUMMARY			0x4 // first summary frame, one per frame 1 signal
+#define CAN_MSG_FILTER			0x7 // decimated suspension stream, see s2c_filter.h. Frame 1 never has 4 summary signals
+#define CAN_MSG_PULSE			0x8 // pulse input frequencies, see s2c_pulse.h
+#define CAN_MSG_BENCH			0x9 // CAN loopback benchmark results, see s2c_can_bench.h
+#define CAN_BITPACK_FRAMES		true // frame 1 uses the exact-width layouts in s2c_bitpack.h
+#define CAN_ZERO_COPY_TX		true // frames are built in place in CAN message RAM, not copied in
+#define CAN_MSG_HEALTH			0xA // CAN error state and statistics, see s2c_can_health.h
+#define CAN_MSG_LOG				0xB // deferred-format log records, see s2c_log.h
+#define CAN_MSG_TRACE_HEADER	0xC // post-mortem trace dump, see s2c_trace.h
+#define CAN_MSG_TRACE			0xD
+#define CAN_MSG_DEBUG			0xE // interrupt statistics, see s2c_irq.h
+#define CAN_MSG_CAPTURE			0xF // highest message number, so lowest priority within a module
+#define CAN_TX_BUFFER_DEBUG		4 // TX buffer shared by the debug frames
+#define CAN_TX_BUFFER_PULSE		5
+#define CAN_TX_BUFFER_ALARM		6 // only the alarm uses it, so it can send from the ADC interrupt
+
+// Change-of-value deadbands are in frame units: deg C for brake temp, 0.02 K for tire temp, 0.01 deg C for radiator, ADC counts otherwise
+#define COV_HEARTBEAT_MS		1000
+
+// Main loop period when the adaptive rate is off
+#define LOOP_PERIOD_MS			20
+
+// Summary window. Every ADC scan in the window adds one value per signal
+#define SUMMARY_WINDOW_MS		1000
+
+// CAN health frame period, and bus-off / error-passive backoff
+#define CAN_HEALTH_PERIOD_MS			1000
+#define CAN_BUS_OFF_RECOVERY_MS			50 // first wait before restarting after a bus-off, doubles on repeats
+#define CAN_BUS_OFF_RECOVERY_MAX_MS		1600
+#define CAN_PASSIVE_TX_INTERVAL_MS		100 // frame 1 rate while error passive
+
+// CAN benchmark: measuring window per case, and how often the results are sent again
+#define CAN_BENCH_WINDOW_MS		50
+#define CAN_BENCH_REPORT_PERIOD_MS	5000
+
+// Interrupt statistics are reported once per period, one source per loop
+#define IRQ_REPORT_PERIOD_MS	1000
+
+// MTB trace buffer, 8 bytes per branch. Power of 2, at least 16
+#define TRACE_BUFFER_BYTES		1024
+
+// Log records waiting to be sent, 8 bytes each. Power of 2
+#define LOG_RING_SLOTS			32
 
 // ADC stuff
 #define ADC_NUM_SAMPLES			4
 #define ADC_SAMPLE_DIV			2
 #define ADC_NUM_CHANNELS		4
+#define ADC_RESULT_BITS			10 // matches ADC_RESOLUTION_10BIT in configure_adc()
+#define ADC_SCAN_RING_SLOTS		4 // completed scans buffered between adc_callback and the main loop, power of 2
+
+// Filtering stage on the sampler stream. Cutoffs scale with SAMPLER_RATE_HZ, see s2c_filter.h
+#define ADC_FILTER_BLOCK_SIZE		32	// samples per filter call, a multiple of ADC_FILTER_DECIMATION that divides SAMPLER_BLOCK_SIZE
+#define ADC_FILTER_DECIMATION		4
+#define ADC_FILTER_FIR_TAPS			16
+#define ADC_FILTER_BIQUAD_STAGES	1
+
+// Fixed-rate sampler and band energy analysis. With rate == block size the FFT bins are exactly 1 Hz apart
+#define SAMPLER_RATE_HZ			256
+#define SAMPLER_BLOCK_SIZE		256	// must be a size supported by arm_rfft_q15
+#define SAMPLER_NUM_BLOCKS		4	// 2 KB, lets analysis fall up to 3 blocks behind. Must be a power of 2
+#define ANALYSIS_NUM_BANDS		4
+#define ANALYSIS_BAND_EDGES_HZ	{ 1, 3, 10, 20, SAMPLER_RATE_HZ / 2 } // body, mid, wheel hop, high
+
+// Event-triggered capture (sampler runs at CAPTURE_RATE_HZ unless analysis mode is also on)
+#define CAPTURE_RATE_HZ				1024
+#define CAPTURE_PRE_SAMPLES			256
+#define CAPTURE_POST_SAMPLES		256
+#define CAPTURE_LENGTH				(CAPTURE_PRE_SAMPLES + CAPTURE_POST_SAMPLES)
+#define CAPTURE_THRESHOLD_LOW		64	// ADC counts, near full droop
+#define CAPTURE_THRESHOLD_HIGH		960	// ADC counts, near full bump
+#define CAPTURE_DERIVATIVE_LIMIT	48	// ADC counts between consecutive samples
+#define CAPTURE_USE_WINDOW_MONITOR	true
+#define CAPTURE_FRAMES_PER_LOOP		2	// TX buffers 2 and 3 are reserved for draining
 
 // I2C stuff
 #define I2C_BRAKE_TEMP			0
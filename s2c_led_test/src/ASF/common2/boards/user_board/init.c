@@ -25,16 +25,16 @@ void system_board_init(void)
 	 * for, e.g., the I/O pins. The initialization can rely on application-
 	 * specific board configuration, found in conf_board.h.
 	 */
-	struct port_config config;
-	port_get_config_defaults(&config);
-	
-	config.direction = PORT_PIN_DIR_OUTPUT;
-	config.input_pull = PORT_PIN_PULL_NONE;
-	port_pin_set_config(LED_USER_PIN, &config);
+	// The PORT driver isn't part of this project, the pins are set up directly
+	PORT->Group[0].DIRSET.reg = LED_USER_PORT;
 	
 #if USE_PINSTRAPS
-	config.direction = PORT_PIN_DIR_INPUT;
-	config.input_pull = PORT_PIN_PULL_UP;
-	port_group_set_config(&PORTA, PINSTRAPS, &config);
+	// Inputs with pull-ups: input buffer and pull enabled, OUT selects pull-up
+	for(uint8_t pin = 0; pin < 32; pin++) {
+		if((PINSTRAPS) & (1ul << pin)) {
+			PORT->Group[0].PINCFG[pin].reg = PORT_PINCFG_INEN | PORT_PINCFG_PULLEN;
+		}
+	}
+	PORT->Group[0].OUTSET.reg = (PINSTRAPS);
 #endif
 }
\ No newline at end of file
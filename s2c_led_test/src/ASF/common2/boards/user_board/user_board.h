@@ -44,11 +44,23 @@ void system_board_init(void);
 #define AN1						ADC_POSITIVE_INPUT_PIN1
 #define AN2						ADC_POSITIVE_INPUT_PIN4
 #define AN3						ADC_POSITIVE_INPUT_PIN5
+// The same inputs as ADC0 AIN numbers and pads, for direct register access
+#define AN0_AIN					0
+#define AN0_PIN					PIN_PA02B_ADC0_AIN0
+#define AN1_AIN					1
+#define AN1_PIN					PIN_PA03B_ADC0_AIN1
+#define AN2_AIN					4
+#define AN2_PIN					PIN_PA04B_ADC0_AIN4
+#define AN3_AIN					5
+#define AN3_PIN					PIN_PA05B_ADC0_AIN5
+#define AN_MUX					MUX_PA02B_ADC0_AIN0 // mux B on all four pads
 
 // I2C
 #define I2C_MASTER_MODULE		SERCOM2
 #define I2C_SDA_PIN				PIN_PA08D_SERCOM2_PAD0
 #define I2C_SCL_PIN				PIN_PA09D_SERCOM2_PAD1
+#define I2C_SDA_MUX				MUX_PA08D_SERCOM2_PAD0
+#define I2C_SCL_MUX				MUX_PA09D_SERCOM2_PAD1
 
 // Pinstraps
 #define PINSTRAP_0				PORT_PA00
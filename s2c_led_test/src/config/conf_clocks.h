@@ -40,7 +40,7 @@
 #  define CONF_CLOCK_CPU_DIVIDER                  SYSTEM_MAIN_CLOCK_DIV_1
 
 /* SYSTEM_CLOCK_SOURCE_OSC48M configuration - Internal 48MHz oscillator */
-#  define CONF_CLOCK_OSC48M_FREQ_DIV              SYSTEM_OSC48M_DIV_12
+#  define CONF_CLOCK_OSC48M_FREQ_DIV              SYSTEM_OSC48M_DIV_1
 #  define CONF_CLOCK_OSC48M_ON_DEMAND             true
 #  define CONF_CLOCK_OSC48M_RUN_IN_STANDBY        false
 
@@ -108,11 +108,12 @@
  * false, none of the GCLK generators will be configured in clocks_init(). */
 #  define CONF_CLOCK_CONFIGURE_GCLK               true
 
-/* Configure GCLK generator 0 (Main Clock) */
+/* Configure GCLK generator 0 (Main Clock). 16 MHz, what the sensor module
+ * boots at, so the bring-up timings carry over */
 #  define CONF_CLOCK_GCLK_0_ENABLE                true
 #  define CONF_CLOCK_GCLK_0_RUN_IN_STANDBY        false
 #  define CONF_CLOCK_GCLK_0_CLOCK_SOURCE          SYSTEM_CLOCK_SOURCE_OSC48M
-#  define CONF_CLOCK_GCLK_0_PRESCALER             1
+#  define CONF_CLOCK_GCLK_0_PRESCALER             3
 #  define CONF_CLOCK_GCLK_0_OUTPUT_ENABLE         false
 
 /* Configure GCLK generator 1 */
@@ -164,8 +165,8 @@
 #  define CONF_CLOCK_GCLK_7_PRESCALER             1
 #  define CONF_CLOCK_GCLK_7_OUTPUT_ENABLE         false
 
-/* Configure GCLK generator 8 */
-#  define CONF_CLOCK_GCLK_8_ENABLE                false
+/* Configure GCLK generator 8 (GCLK_CAN, 48 MHz as on the sensor module) */
+#  define CONF_CLOCK_GCLK_8_ENABLE                true
 #  define CONF_CLOCK_GCLK_8_RUN_IN_STANDBY        false
 #  define CONF_CLOCK_GCLK_8_CLOCK_SOURCE          SYSTEM_CLOCK_SOURCE_OSC48M
 #  define CONF_CLOCK_GCLK_8_PRESCALER             1
@@ -1,7 +1,7 @@
 /**
  * \file
  *
- * \brief Empty user application template
+ * \brief Bring-up self-test, see s2c_bringup.h
  *
  */
 
@@ -28,10 +28,104 @@
  * Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
  */
 #include <asf.h>
+#include <s2c_bringup.h>
+
+#define LED_PASS_PERIOD_MS		200 // 5 Hz
+#define LED_FAIL_PERIOD_MS		2000 // one flash per failed test number, then a pause
+#define LED_FLASH_MS			150
+
+uint8_t get_pinstrap_id(void);
+bool led_state(uint8_t failed, uint16_t phase_ms);
+
+static struct bringup_results results;
+
+/**
+ * \brief Gets board ID from pinstrap configuration
+ * 
+ * \return Board ID
+ * 
+ */
+uint8_t get_pinstrap_id(void) {
+	uint32_t input = PORT->Group[0].IN.reg;
+	return	((input & PINSTRAP_0) > 0) | 
+			(((input & PINSTRAP_1) > 0) << 1) | 
+			(((input & PINSTRAP_2) > 0) << 2) | 
+			(((input & PINSTRAP_3) > 0) << 3);
+}
+
+/**
+ * \brief Gets the LED state for the results
+ *
+ * Blinks at 5 Hz if every test passed. Otherwise flashes n + 1 times every
+ * LED_FAIL_PERIOD_MS, n being the first failed test (enum bringup_test).
+ *
+ * \param failed	failed test mask
+ * \param phase_ms	time since boot, in ms
+ *
+ * \return true if the LED is on
+ *
+ */
+bool led_state(uint8_t failed, uint16_t phase_ms) {
+	if(failed == 0) {
+		return (phase_ms % LED_PASS_PERIOD_MS) < LED_PASS_PERIOD_MS / 2;
+	}
+	phase_ms %= LED_FAIL_PERIOD_MS;
+	uint8_t flashes = __builtin_ctz(failed) + 1;
+	return phase_ms / (2 * LED_FLASH_MS) < flashes && (phase_ms % (2 * LED_FLASH_MS)) < LED_FLASH_MS;
+}
 
 int main (void)
 {
 	system_init();
-
-	/* Insert application code here, after the board has been initialized. */
+	bringup_init();
+	
+	uint8_t board_id = get_pinstrap_id();
+	
+	// The MLX sensors this board type carries, see s2c_utils.h
+	uint8_t mlx_addresses[BRINGUP_MLX_MAX_DEVICES];
+	uint8_t mlx_count = 0;
+	switch(get_board_type_from_id(board_id)) {
+	case S2C_BOARD_WHEEL:
+		mlx_addresses[mlx_count++] = I2C_MLX_WHEEL_ID;
+		break;
+	
+	case S2C_BOARD_TIRE_TEMP:
+		mlx_addresses[mlx_count++] = I2C_MLX_INNER_ID;
+		mlx_addresses[mlx_count++] = I2C_MLX_MIDDLE_ID;
+		mlx_addresses[mlx_count++] = I2C_MLX_OUTER_ID;
+		break;
+	
+	default:
+		break;
+	}
+	
+	// Each test is timed on its own, the cycle counter only spans about a second
+	uint32_t start = bringup_cycles();
+	if(!bringup_adc(results.adc)) results.failed |= 1 << BRINGUP_TEST_ADC;
+	results.test_ms = bringup_elapsed_us(start) / 1000;
+	
+	start = bringup_cycles();
+	if(!bringup_i2c(mlx_addresses, mlx_count, &results)) results.failed |= 1 << BRINGUP_TEST_I2C;
+	results.test_ms += bringup_elapsed_us(start) / 1000;
+	
+	start = bringup_cycles();
+	if(!bringup_can(&results.can)) results.failed |= 1 << BRINGUP_TEST_CAN;
+	results.test_ms += bringup_elapsed_us(start) / 1000;
+	
+	uint32_t ms = 0;
+	start = bringup_cycles();
+	while (1) {
+		if(bringup_elapsed_us(start) < 1000) continue;
+		start = bringup_cycles();
+		++ms;
+		
+		if(led_state(results.failed, ms % 60000)) {
+			PORT->Group[0].OUTSET.reg = LED_USER_PORT;
+		} else {
+			PORT->Group[0].OUTCLR.reg = LED_USER_PORT;
+		}
+		if(ms % BRINGUP_REPORT_PERIOD_MS == 0) {
+			bringup_report(board_id, &results);
+		}
+	}
 }
@@ -0,0 +1,485 @@
+/*
+ * s2c_bringup.c
+ *
+ * Created: 2026-10-20 9:12:40 AM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_bringup.h>
+#include <s2c_can_timing.h>
+#include <string.h>
+
+#define BRINGUP_CYCLES_MASK		0xFFFFFF // SysTick is 24-bit
+
+#define BRINGUP_MLX_TOBJ1		0x07 // RAM address of object temperature 1
+
+// GCLK_CAN is generator 8, 48 MHz, see conf_clocks.h
+#define BRINGUP_CAN_GCLK_HZ		48000000UL
+#define BRINGUP_CAN_BRP			S2C_CAN_BRP(BRINGUP_CAN_GCLK_HZ, BRINGUP_CAN_BITRATE, 8, 25)
+#define BRINGUP_CAN_TQ			S2C_CAN_TQ(BRINGUP_CAN_GCLK_HZ, BRINGUP_CAN_BITRATE, BRINGUP_CAN_BRP)
+_Static_assert(S2C_CAN_TIMING_VALID(BRINGUP_CAN_TQ, BRINGUP_CAN_SAMPLE_POINT, 256, 128),
+		"BRINGUP_CAN_BITRATE can't be reached from GCLK_CAN");
+
+#define BRINGUP_CAN_TEST_ID		0x555 // alternating bits, few stuff bits
+#define BRINGUP_CAN_TX_SLOTS	16
+#define BRINGUP_CAN_RX_SLOTS	16
+
+// Message RAM. Elements are sized for 64 data bytes so they match the CMSIS element structs
+static CanMramTxbe bringup_can_tx[BRINGUP_CAN_TX_SLOTS];
+static CanMramRxf0e bringup_can_rx[BRINGUP_CAN_RX_SLOTS];
+
+static uint32_t bringup_cycles_per_us = 1;
+
+static const uint8_t bringup_adc_ain[BRINGUP_ADC_NUM_INPUTS] = {AN0_AIN, AN1_AIN, AN2_AIN, AN3_AIN,
+		ADC_INPUTCTRL_MUXPOS_SCALEDIOVCC_Val};
+static const uint8_t bringup_adc_pins[] = {AN0_PIN, AN1_PIN, AN2_PIN, AN3_PIN};
+
+static SercomI2cm *const bringup_i2c_hw = &I2C_MASTER_MODULE->I2CM;
+
+/**
+ * \brief Starts the SysTick cycle counter everything is timed with
+ *
+ * Call right after system_init(), once the clocks are running.
+ *
+ */
+void bringup_init(void) {
+	bringup_cycles_per_us = system_cpu_clock_get_hz() / 1000000;
+	SysTick->LOAD = BRINGUP_CYCLES_MASK;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+/**
+ * \brief Gets a free-running CPU cycle count, wraps every 2^24 cycles
+ */
+uint32_t bringup_cycles(void) {
+	return BRINGUP_CYCLES_MASK - SysTick->VAL;
+}
+
+/**
+ * \brief Gets the time since a bringup_cycles() reading, up to one SysTick wrap
+ */
+uint32_t bringup_elapsed_us(uint32_t start) {
+	return ((bringup_cycles() - start) & BRINGUP_CYCLES_MASK) / bringup_cycles_per_us;
+}
+
+static void bringup_adc_sync(void) {
+	while(ADC0->SYNCBUSY.reg);
+}
+
+static uint16_t bringup_adc_convert(uint32_t *cycles) {
+	uint32_t start = bringup_cycles();
+	ADC0->SWTRIG.reg = ADC_SWTRIG_START;
+	while(!(ADC0->INTFLAG.reg & ADC_INTFLAG_RESRDY));
+	*cycles += (bringup_cycles() - start) & BRINGUP_CYCLES_MASK;
+	// Reading the result clears RESRDY
+	return ADC0->RESULT.reg;
+}
+
+/**
+ * \brief Measures the noise floor and conversion time of every ADC input
+ *
+ * \param results	BRINGUP_ADC_NUM_INPUTS results, AN0 to AN3 then VDDIO/4
+ *
+ * \return true if VDDIO/4 reads quarter scale with little enough noise
+ *
+ */
+bool bringup_adc(struct bringup_adc_result *results) {
+	MCLK->APBCMASK.reg |= MCLK_APBCMASK_ADC0;
+	GCLK->PCHCTRL[ADC0_GCLK_ID].reg = GCLK_PCHCTRL_GEN_GCLK0 | GCLK_PCHCTRL_CHEN;
+	while(!(GCLK->PCHCTRL[ADC0_GCLK_ID].reg & GCLK_PCHCTRL_CHEN));
+
+	struct system_pinmux_config pin_config;
+	system_pinmux_get_config_defaults(&pin_config);
+	pin_config.mux_position = AN_MUX;
+	pin_config.input_pull = SYSTEM_PINMUX_PIN_PULL_NONE;
+	for(uint8_t i = 0; i < sizeof(bringup_adc_pins); i++) {
+		system_pinmux_pin_set_config(bringup_adc_pins[i], &pin_config);
+	}
+
+	// Factory bias calibration, as adc_init() loads it, then configure_adc()'s settings
+	uint32_t fuses = *(const uint32_t *)ADC0_FUSES_BIASCOMP_ADDR;
+	ADC0->CALIB.reg = ADC_CALIB_BIASCOMP((fuses & ADC0_FUSES_BIASCOMP_Msk) >> ADC0_FUSES_BIASCOMP_Pos) |
+		ADC_CALIB_BIASREFBUF((fuses & ADC0_FUSES_BIASREFBUF_Msk) >> ADC0_FUSES_BIASREFBUF_Pos);
+	ADC0->CTRLB.reg = ADC_CTRLB_PRESCALER_DIV8;
+	ADC0->REFCTRL.reg = ADC_REFCTRL_REFSEL_INTVCC2;
+	ADC0->CTRLC.reg = ADC_CTRLC_RESSEL_10BIT;
+	bringup_adc_sync();
+	ADC0->CTRLA.reg = ADC_CTRLA_ENABLE;
+	bringup_adc_sync();
+
+	for(uint8_t i = 0; i < BRINGUP_ADC_NUM_INPUTS; i++) {
+		ADC0->INPUTCTRL.reg = ADC_INPUTCTRL_MUXPOS(bringup_adc_ain[i]) | ADC_INPUTCTRL_MUXNEG(0x18); // GND
+		bringup_adc_sync();
+
+		// The first conversion after a mux change is thrown away
+		uint32_t cycles = 0;
+		bringup_adc_convert(&cycles);
+		cycles = 0;
+
+		struct s2c_stats stats;
+		s2c_stats_reset(&stats);
+		for(uint16_t n = 0; n < BRINGUP_ADC_SAMPLES; n++) {
+			s2c_stats_add(&stats, bringup_adc_convert(&cycles));
+			bringup_adc_sync();
+		}
+
+		// Variance in 1/256 LSB^2, both terms fit 32 bits at 10-bit resolution
+		uint32_t mean_16 = (stats.sum * 16 + BRINGUP_ADC_SAMPLES / 2) / BRINGUP_ADC_SAMPLES;
+		uint32_t mean_sq_256 = stats.sum_sq * 256 / BRINGUP_ADC_SAMPLES;
+		uint32_t spread = stats.max - stats.min;
+		results[i].mean = (mean_16 + 8) / 16;
+		results[i].noise = (mean_sq_256 > mean_16 * mean_16) ? s2c_isqrt(mean_sq_256 - mean_16 * mean_16) : 0;
+		results[i].peak_to_peak = (spread > 0xFF) ? 0xFF : spread;
+		results[i].conversion_ns = cycles * 1000 / bringup_cycles_per_us / BRINGUP_ADC_SAMPLES;
+	}
+
+	ADC0->CTRLA.reg = 0;
+	bringup_adc_sync();
+
+	const struct bringup_adc_result *vddio = &results[BRINGUP_ADC_NUM_INPUTS - 1];
+	int16_t error = (int16_t)vddio->mean - (1 << ADC_RESULT_BITS) / 4;
+	return error <= BRINGUP_ADC_MAX_ERROR_LSB && error >= -BRINGUP_ADC_MAX_ERROR_LSB &&
+		vddio->peak_to_peak <= BRINGUP_ADC_MAX_NOISE_LSB;
+}
+
+static void bringup_i2c_sync(void) {
+	while(bringup_i2c_hw->SYNCBUSY.reg);
+}
+
+/**
+ * \brief Waits for the current address or data byte, MB after a write, SB after a read
+ */
+static enum bringup_i2c_status bringup_i2c_wait(void) {
+	uint32_t start = bringup_cycles();
+	while(!(bringup_i2c_hw->INTFLAG.reg & (SERCOM_I2CM_INTFLAG_MB | SERCOM_I2CM_INTFLAG_SB))) {
+		if(bringup_elapsed_us(start) > BRINGUP_I2C_TIMEOUT_US) return BRINGUP_I2C_BUS_ERROR;
+	}
+	if(bringup_i2c_hw->STATUS.reg & (SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST)) return BRINGUP_I2C_BUS_ERROR;
+	if(bringup_i2c_hw->STATUS.reg & SERCOM_I2CM_STATUS_RXNACK) return BRINGUP_I2C_NACK;
+	return BRINGUP_I2C_OK;
+}
+
+static void bringup_i2c_address(uint8_t address_rw) {
+	bringup_i2c_hw->ADDR.reg = SERCOM_I2CM_ADDR_ADDR(address_rw);
+	bringup_i2c_sync();
+}
+
+static void bringup_i2c_stop(void) {
+	bringup_i2c_hw->CTRLB.reg |= SERCOM_I2CM_CTRLB_CMD(3);
+	bringup_i2c_sync();
+	// Back to idle after a bus error or timeout, so the next transaction can start
+	if(bringup_i2c_hw->STATUS.bit.BUSSTATE != 1) {
+		bringup_i2c_hw->STATUS.reg = SERCOM_I2CM_STATUS_BUSSTATE(1);
+		bringup_i2c_sync();
+	}
+}
+
+/**
+ * \brief SMBus CRC-8 (x^8 + x^2 + x + 1), the MLX packet error code
+ */
+static uint8_t bringup_crc8(const uint8_t *data, uint8_t length) {
+	uint8_t crc = 0;
+	for(uint8_t i = 0; i < length; i++) {
+		crc ^= data[i];
+		for(uint8_t bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+/**
+ * \brief Reads one MLX RAM word: command, repeated start, LSB, MSB and PEC
+ */
+static enum bringup_i2c_status bringup_mlx_read(uint8_t address, uint8_t command, uint16_t *value) {
+	uint8_t packet[6] = {address << 1, command, (address << 1) | 1};
+
+	bringup_i2c_hw->CTRLB.reg &= ~SERCOM_I2CM_CTRLB_ACKACT;
+	bringup_i2c_address(packet[0]);
+	enum bringup_i2c_status status = bringup_i2c_wait();
+	if(status == BRINGUP_I2C_OK) {
+		bringup_i2c_hw->DATA.reg = command;
+		bringup_i2c_sync();
+		status = bringup_i2c_wait();
+	}
+	if(status == BRINGUP_I2C_OK) {
+		bringup_i2c_address(packet[2]);
+		status = bringup_i2c_wait();
+	}
+	// Smart mode: reading DATA acks the byte and clocks in the next one
+	for(uint8_t i = 3; i < 5 && status == BRINGUP_I2C_OK; i++) {
+		packet[i] = bringup_i2c_hw->DATA.reg;
+		bringup_i2c_sync();
+		status = bringup_i2c_wait();
+	}
+	if(status != BRINGUP_I2C_OK) {
+		bringup_i2c_stop();
+		return status;
+	}
+
+	// NACK and stop, then take the last byte
+	bringup_i2c_hw->CTRLB.reg |= SERCOM_I2CM_CTRLB_ACKACT | SERCOM_I2CM_CTRLB_CMD(3);
+	bringup_i2c_sync();
+	packet[5] = bringup_i2c_hw->DATA.reg;
+
+	*value = packet[3] | (packet[4] << 8);
+	return (bringup_crc8(packet, 5) == packet[5]) ? BRINGUP_I2C_OK : BRINGUP_I2C_PEC;
+}
+
+/**
+ * \brief Scans the I2C bus and reads each expected MLX sensor
+ *
+ * \param addresses	7-bit addresses of the MLX sensors this board type should have
+ * \param count		number of addresses, up to BRINGUP_MLX_MAX_DEVICES
+ * \param results	i2c_devices, mlx_count and mlx are filled
+ *
+ * \return true if every expected sensor gave a plausible temperature
+ *
+ */
+bool bringup_i2c(const uint8_t *addresses, uint8_t count, struct bringup_results *results) {
+	MCLK->APBCMASK.reg |= MCLK_APBCMASK_SERCOM2; // I2C_MASTER_MODULE
+	GCLK->PCHCTRL[SERCOM2_GCLK_ID_CORE].reg = GCLK_PCHCTRL_GEN_GCLK0 | GCLK_PCHCTRL_CHEN;
+	while(!(GCLK->PCHCTRL[SERCOM2_GCLK_ID_CORE].reg & GCLK_PCHCTRL_CHEN));
+
+	struct system_pinmux_config pin_config;
+	system_pinmux_get_config_defaults(&pin_config);
+	pin_config.mux_position = I2C_SDA_MUX;
+	system_pinmux_pin_set_config(I2C_SDA_PIN, &pin_config);
+	pin_config.mux_position = I2C_SCL_MUX;
+	system_pinmux_pin_set_config(I2C_SCL_PIN, &pin_config);
+
+	// Master, 300-600 ns SDA hold and smart mode, as i2c_master_init() sets them. Rise time is ignored
+	bringup_i2c_hw->CTRLA.reg = SERCOM_I2CM_CTRLA_MODE(0x5) | SERCOM_I2CM_CTRLA_SDAHOLD(0x2);
+	bringup_i2c_hw->CTRLB.reg = SERCOM_I2CM_CTRLB_SMEN;
+	bringup_i2c_hw->BAUD.reg = SERCOM_I2CM_BAUD_BAUD(system_gclk_gen_get_hz(GCLK_GENERATOR_0) / (2 * BRINGUP_I2C_BAUD_HZ) - 5);
+	bringup_i2c_sync();
+	bringup_i2c_hw->CTRLA.reg |= SERCOM_I2CM_CTRLA_ENABLE;
+	bringup_i2c_sync();
+	bringup_i2c_hw->STATUS.reg = SERCOM_I2CM_STATUS_BUSSTATE(1); // idle
+	bringup_i2c_sync();
+
+	// Every address outside the reserved ones, write direction, stop right after the ACK
+	results->i2c_devices = 0;
+	for(uint8_t address = 0x08; address < 0x78; address++) {
+		bringup_i2c_address(address << 1);
+		if(bringup_i2c_wait() == BRINGUP_I2C_OK) ++results->i2c_devices;
+		bringup_i2c_stop();
+	}
+
+	bool pass = true;
+	results->mlx_count = count;
+	for(uint8_t i = 0; i < count; i++) {
+		struct bringup_mlx_result *mlx = &results->mlx[i];
+		mlx->address = addresses[i];
+		mlx->raw = 0;
+
+		uint32_t start = bringup_cycles();
+		mlx->status = bringup_mlx_read(addresses[i], BRINGUP_MLX_TOBJ1, &mlx->raw);
+		mlx->latency_us = bringup_elapsed_us(start);
+
+		if(mlx->status == BRINGUP_I2C_OK && (mlx->raw < BRINGUP_MLX_MIN_RAW || mlx->raw > BRINGUP_MLX_MAX_RAW)) {
+			mlx->status = BRINGUP_I2C_RANGE;
+		}
+		pass = pass && mlx->status == BRINGUP_I2C_OK;
+	}
+
+	bringup_i2c_hw->CTRLA.reg &= ~SERCOM_I2CM_CTRLA_ENABLE;
+	bringup_i2c_sync();
+	return pass;
+}
+
+/**
+ * \brief (Re)configures the CAN controller and starts it
+ *
+ * \param loopback	true for internal loopback, false to run on the bus
+ *
+ */
+static void bringup_can_start(bool loopback) {
+	CAN0->CCCR.reg = CAN_CCCR_INIT;
+	while(!(CAN0->CCCR.reg & CAN_CCCR_INIT));
+	// CCE only takes once INIT is set, and TEST / MON once CCE is, so one write each.
+	// Without loopback this write also clears TEST and MON from a previous run
+	CAN0->CCCR.reg = CAN_CCCR_INIT | CAN_CCCR_CCE;
+	if(loopback) {
+		CAN0->CCCR.reg |= CAN_CCCR_TEST | CAN_CCCR_MON;
+		CAN0->TEST.reg = CAN_TEST_LBCK;
+	}
+
+	CAN0->NBTP.reg = CAN_NBTP_NBRP(BRINGUP_CAN_BRP - 1) |
+		CAN_NBTP_NSJW(S2C_CAN_SJW(BRINGUP_CAN_TQ, BRINGUP_CAN_SAMPLE_POINT, 128) - 1) |
+		CAN_NBTP_NTSEG1(S2C_CAN_TSEG1(BRINGUP_CAN_TQ, BRINGUP_CAN_SAMPLE_POINT) - 1) |
+		CAN_NBTP_NTSEG2(S2C_CAN_TSEG2(BRINGUP_CAN_TQ, BRINGUP_CAN_SAMPLE_POINT) - 1);
+	// All TX elements form the FIFO, every frame goes to RX FIFO 0
+	CAN0->TXBC.reg = CAN_TXBC_TBSA((uint32_t)bringup_can_tx) | CAN_TXBC_TFQS(BRINGUP_CAN_TX_SLOTS);
+	CAN0->TXESC.reg = CAN_TXESC_TBDS_DATA64;
+	CAN0->RXF0C.reg = CAN_RXF0C_F0SA((uint32_t)bringup_can_rx) | CAN_RXF0C_F0S(BRINGUP_CAN_RX_SLOTS);
+	CAN0->RXESC.reg = CAN_RXESC_F0DS_DATA64;
+	CAN0->GFC.reg = CAN_GFC_ANFS_RXF0 | CAN_GFC_ANFE_REJECT;
+
+	// Leaving INIT clears CCE too
+	CAN0->CCCR.reg &= ~CAN_CCCR_INIT;
+	while(CAN0->CCCR.reg & CAN_CCCR_INIT);
+}
+
+/**
+ * \brief Queues one classic frame in the TX FIFO
+ *
+ * \return false if the FIFO was full
+ *
+ */
+static bool bringup_can_send(uint16_t id, const uint32_t *data) {
+	if(CAN0->TXFQS.reg & CAN_TXFQS_TFQF) return false;
+
+	uint8_t index = (CAN0->TXFQS.reg & CAN_TXFQS_TFQPI_Msk) >> CAN_TXFQS_TFQPI_Pos;
+	CanMramTxbe *element = &bringup_can_tx[index];
+	element->TXBE_0.reg = CAN_TXBE_0_ID(id << 18); // standard IDs sit in bits 28:18
+	element->TXBE_1.reg = CAN_TXBE_1_DLC(8);
+	element->TXBE_DATA[0].reg = data[0];
+	element->TXBE_DATA[1].reg = data[1];
+	CAN0->TXBAR.reg = 1ul << index;
+	return true;
+}
+
+/**
+ * \brief Takes every frame waiting in RX FIFO 0 and checks the test sequence
+ *
+ * \param sequence	next expected sequence number, advanced past each frame
+ * \param bad		incremented for every gap, corrupted or unexpected frame
+ *
+ * \return number of frames taken
+ *
+ */
+static uint16_t bringup_can_receive(uint32_t *sequence, uint16_t *bad) {
+	uint16_t count = 0;
+	while(CAN0->RXF0S.reg & CAN_RXF0S_F0FL_Msk) {
+		uint8_t index = (CAN0->RXF0S.reg & CAN_RXF0S_F0GI_Msk) >> CAN_RXF0S_F0GI_Pos;
+		CanMramRxf0e *element = &bringup_can_rx[index];
+		uint32_t id = (element->RXF0E_0.reg & CAN_RXF0E_0_ID_Msk) >> 18;
+		uint32_t dlc = (element->RXF0E_1.reg & CAN_RXF0E_1_DLC_Msk) >> CAN_RXF0E_1_DLC_Pos;
+		uint32_t value = element->RXF0E_DATA[0].reg;
+		if(id != BRINGUP_CAN_TEST_ID || dlc != 8 || element->RXF0E_DATA[1].reg != ~value || value != *sequence) {
+			++*bad;
+		}
+		*sequence = value + 1;
+		CAN0->RXF0A.reg = CAN_RXF0A_F0AI(index);
+		++count;
+	}
+	return count;
+}
+
+/**
+ * \brief Measures the loopback frame rate, then leaves CAN running on the bus
+ *
+ * \return true if no frame was lost or corrupted and the rate was close to the bitrate's
+ *
+ */
+bool bringup_can(struct bringup_can_result *result) {
+	MCLK->AHBMASK.reg |= MCLK_AHBMASK_CAN0;
+	GCLK->PCHCTRL[CAN0_GCLK_ID].reg = GCLK_PCHCTRL_GEN(8) | GCLK_PCHCTRL_CHEN;
+	while(!(GCLK->PCHCTRL[CAN0_GCLK_ID].reg & GCLK_PCHCTRL_CHEN));
+
+	struct system_pinmux_config pin_config;
+	system_pinmux_get_config_defaults(&pin_config);
+	pin_config.mux_position = CAN_TX_MUX_SETTING;
+	system_pinmux_pin_set_config(CAN_TX_PIN, &pin_config);
+	pin_config.mux_position = CAN_RX_MUX_SETTING;
+	system_pinmux_pin_set_config(CAN_RX_PIN, &pin_config);
+	// Transceiver out of standby, it only matters for the report
+	PORT->Group[0].DIRSET.reg = 1ul << CAN_STBY_PIN;
+	PORT->Group[0].OUTCLR.reg = 1ul << CAN_STBY_PIN;
+
+	bringup_can_start(true);
+
+	uint32_t next = 0, expected = 0, queue_cycles = 0, sent = 0;
+	uint16_t bad = 0, received = 0;
+	uint32_t start = bringup_cycles();
+	while(bringup_elapsed_us(start) < BRINGUP_CAN_WINDOW_MS * 1000UL) {
+		uint32_t data[2] = {next, ~next};
+		uint32_t queue_start = bringup_cycles();
+		if(bringup_can_send(BRINGUP_CAN_TEST_ID, data)) {
+			queue_cycles += (bringup_cycles() - queue_start) & BRINGUP_CYCLES_MASK;
+			++next;
+			++sent;
+		}
+		received += bringup_can_receive(&expected, &bad);
+	}
+	result->frames_per_s = (uint32_t)received * 1000 / BRINGUP_CAN_WINDOW_MS;
+
+	// Let the FIFO run dry, a frame takes a few hundred us
+	start = bringup_cycles();
+	uint32_t total = received;
+	while(bringup_elapsed_us(start) < 10000) {
+		total += bringup_can_receive(&expected, &bad);
+	}
+	if(CAN0->RXF0S.reg & CAN_RXF0S_RF0L) ++bad;
+
+	result->max_frames_per_s = BRINGUP_CAN_BITRATE / BRINGUP_CAN_FRAME_BITS;
+	result->lost = bad + (sent - total);
+	result->queue_cycles = sent ? queue_cycles / sent : 0;
+
+	bringup_can_start(false);
+	return result->lost == 0 &&
+		(uint32_t)result->frames_per_s * 1000 >= (uint32_t)result->max_frames_per_s * BRINGUP_CAN_MIN_RATE_PERMILLE;
+}
+
+static void bringup_pack(uint32_t *data, const uint8_t *bytes) {
+	data[0] = bytes[0] | (bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	data[1] = bytes[4] | (bytes[5] << 8) | ((uint32_t)bytes[6] << 16) | ((uint32_t)bytes[7] << 24);
+}
+
+/**
+ * \brief Queues the result frames, see s2c_bringup.h for the layout
+ *
+ * Call every BRINGUP_REPORT_PERIOD_MS after bringup_can(). Whatever is still
+ * pending from the last report found no listener and is dropped.
+ *
+ */
+void bringup_report(uint8_t board_id, const struct bringup_results *results) {
+	static uint8_t counter = 0;
+	uint8_t bytes[8];
+	uint32_t data[2];
+
+	uint32_t start = bringup_cycles();
+	CAN0->TXBCR.reg = CAN0->TXBRP.reg;
+	while(CAN0->TXBRP.reg && bringup_elapsed_us(start) < 10000);
+	// Bus-off sets INIT, clearing it starts the recovery
+	if(CAN0->CCCR.reg & CAN_CCCR_INIT) {
+		CAN0->CCCR.reg &= ~CAN_CCCR_INIT;
+	}
+
+	memset(bytes, 0, sizeof(bytes));
+	bytes[0] = results->failed;
+	bytes[1] = counter++;
+	convert_16_bit_to_byte_array(results->test_ms, bytes + 2);
+	bringup_pack(data, bytes);
+	bringup_can_send(CAN_MSG_ID(board_id, BRINGUP_MSG_SUMMARY), data);
+
+	for(uint8_t i = 0; i < BRINGUP_ADC_NUM_INPUTS; i++) {
+		bytes[0] = i;
+		bytes[1] = results->adc[i].peak_to_peak;
+		convert_16_bit_to_byte_array(results->adc[i].mean, bytes + 2);
+		convert_16_bit_to_byte_array(results->adc[i].noise, bytes + 4);
+		convert_16_bit_to_byte_array(results->adc[i].conversion_ns, bytes + 6);
+		bringup_pack(data, bytes);
+		bringup_can_send(CAN_MSG_ID(board_id, BRINGUP_MSG_ADC), data);
+	}
+
+	for(uint8_t i = 0; i < results->mlx_count; i++) {
+		bytes[0] = results->mlx[i].address;
+		bytes[1] = results->mlx[i].status;
+		convert_16_bit_to_byte_array(results->mlx[i].raw, bytes + 2);
+		convert_16_bit_to_byte_array(results->mlx[i].latency_us, bytes + 4);
+		bytes[6] = results->i2c_devices;
+		bytes[7] = 0;
+		bringup_pack(data, bytes);
+		bringup_can_send(CAN_MSG_ID(board_id, BRINGUP_MSG_I2C), data);
+	}
+
+	convert_16_bit_to_byte_array(results->can.frames_per_s, bytes);
+	convert_16_bit_to_byte_array(results->can.max_frames_per_s, bytes + 2);
+	convert_16_bit_to_byte_array(results->can.lost, bytes + 4);
+	convert_16_bit_to_byte_array(results->can.queue_cycles, bytes + 6);
+	bringup_pack(data, bytes);
+	bringup_can_send(CAN_MSG_ID(board_id, BRINGUP_MSG_CAN), data);
+}
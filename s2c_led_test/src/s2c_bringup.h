@@ -0,0 +1,127 @@
+/*
+ * s2c_bringup.h
+ *
+ * Created: 2026-10-20 9:12:40 AM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_BRINGUP_H_
+#define S2C_BRINGUP_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Bring-up self-test.
+ *
+ * Three tests characterise a freshly assembled board in about a second, each
+ * with a pass/fail limit below. Only the system drivers are part of this
+ * project, so the peripherals are programmed directly.
+ *
+ * - ADC: BRINGUP_ADC_SAMPLES polled conversions of AN0 to AN3 and of VDDIO/4,
+ *   with the sensor module's ADC settings. Reports mean, RMS noise and
+ *   peak-to-peak noise, and the conversion time. Only VDDIO/4 has a known
+ *   value, so only it is judged: within BRINGUP_ADC_MAX_ERROR_LSB of quarter
+ *   scale, no more than BRINGUP_ADC_MAX_NOISE_LSB peak-to-peak.
+ * - I2C: probes every address, then reads object temperature 1 from each MLX
+ *   the board type should have, checking the PEC and timing the read. Fails
+ *   if one is missing, returns a bad PEC or an implausible temperature.
+ * - CAN: internal loopback (TEST.LBCK with CCCR.MON, the pins stay recessive)
+ *   at BRINGUP_CAN_BITRATE. Keeps the TX FIFO full for BRINGUP_CAN_WINDOW_MS
+ *   while checking every looped back frame. Fails on a lost or corrupted frame
+ *   or below BRINGUP_CAN_MIN_RATE_PERMILLE of the bitrate's frame rate.
+ *
+ * Afterwards the CAN controller runs normally at the same bitrate and the
+ * results go out every BRINGUP_REPORT_PERIOD_MS (8 bytes each):
+ * - CAN_MSG_ID(id, BRINGUP_MSG_SUMMARY): byte 0: failed test mask (bit n for
+ *   test n), byte 1: report counter, bytes 2 & 3: test time in ms
+ * - CAN_MSG_ID(id, BRINGUP_MSG_ADC), one per input: byte 0: input (4 is
+ *   VDDIO/4), byte 1: peak-to-peak noise in LSB, bytes 2 & 3: mean,
+ *   bytes 4 & 5: RMS noise in 1/16 LSB, bytes 6 & 7: conversion time in ns
+ * - CAN_MSG_ID(id, BRINGUP_MSG_I2C), one per expected MLX: byte 0: address,
+ *   byte 1: enum bringup_i2c_status, bytes 2 & 3: raw temperature (0.02 K),
+ *   bytes 4 & 5: read latency in us, byte 6: devices answering on the bus
+ * - CAN_MSG_ID(id, BRINGUP_MSG_CAN): bytes 0 & 1: frames/s, bytes 2 & 3:
+ *   frames/s the bitrate allows, bytes 4 & 5: lost or corrupted frames,
+ *   bytes 6 & 7: CPU cycles to queue one frame
+ */
+
+enum bringup_test {
+	BRINGUP_TEST_ADC,
+	BRINGUP_TEST_I2C,
+	BRINGUP_TEST_CAN,
+	BRINGUP_NUM_TESTS
+};
+
+enum bringup_i2c_status {
+	BRINGUP_I2C_OK,
+	BRINGUP_I2C_NACK,		// no device at the address
+	BRINGUP_I2C_PEC,		// the SMBus packet error code didn't match
+	BRINGUP_I2C_RANGE,		// temperature outside BRINGUP_MLX_MIN_RAW to BRINGUP_MLX_MAX_RAW
+	BRINGUP_I2C_BUS_ERROR	// timeout, arbitration lost or bus error
+};
+
+#define BRINGUP_MSG_SUMMARY			0x0
+#define BRINGUP_MSG_ADC				0x1
+#define BRINGUP_MSG_I2C				0x2
+#define BRINGUP_MSG_CAN				0x3
+#define BRINGUP_REPORT_PERIOD_MS	1000
+
+#define BRINGUP_ADC_NUM_INPUTS		5 // AN0 to AN3, then VDDIO/4
+#define BRINGUP_ADC_SAMPLES			256
+#define BRINGUP_ADC_MAX_ERROR_LSB	13 // 5 % of quarter scale
+#define BRINGUP_ADC_MAX_NOISE_LSB	4
+
+#define BRINGUP_I2C_BAUD_HZ			100000
+#define BRINGUP_I2C_TIMEOUT_US		5000 // per bus operation
+#define BRINGUP_MLX_MAX_DEVICES		I2C_NUM_TEMP_SENSORS
+#define BRINGUP_MLX_MIN_RAW			11658 // -40 deg C in 0.02 K
+#define BRINGUP_MLX_MAX_RAW			19908 // 125 deg C
+
+#define BRINGUP_CAN_BITRATE			500000UL
+#define BRINGUP_CAN_SAMPLE_POINT	875
+#define BRINGUP_CAN_WINDOW_MS		100
+#define BRINGUP_CAN_FRAME_BITS		111 // standard ID, 8 bytes, interframe space, no stuff bits
+#define BRINGUP_CAN_MIN_RATE_PERMILLE	850 // stuff bits cost the rest
+
+struct bringup_adc_result {
+	uint16_t mean;
+	uint16_t noise;			// RMS, 1/16 LSB
+	uint8_t peak_to_peak;	// LSB, saturates at 255
+	uint16_t conversion_ns;
+};
+
+struct bringup_mlx_result {
+	uint8_t address;
+	uint8_t status;			// enum bringup_i2c_status
+	uint16_t raw;			// object temperature 1, 0.02 K
+	uint16_t latency_us;	// whole read word transaction
+};
+
+struct bringup_can_result {
+	uint16_t frames_per_s;
+	uint16_t max_frames_per_s;
+	uint16_t lost;
+	uint16_t queue_cycles;
+};
+
+struct bringup_results {
+	uint8_t failed;			// bit n set if test n failed
+	uint16_t test_ms;
+	struct bringup_adc_result adc[BRINGUP_ADC_NUM_INPUTS];
+	uint8_t i2c_devices;	// addresses that answered
+	uint8_t mlx_count;
+	struct bringup_mlx_result mlx[BRINGUP_MLX_MAX_DEVICES];
+	struct bringup_can_result can;
+};
+
+void bringup_init(void);
+uint32_t bringup_cycles(void);
+uint32_t bringup_elapsed_us(uint32_t start);
+bool bringup_adc(struct bringup_adc_result *results);
+bool bringup_i2c(const uint8_t *addresses, uint8_t count, struct bringup_results *results);
+bool bringup_can(struct bringup_can_result *result);
+void bringup_report(uint8_t board_id, const struct bringup_results *results);
+
+#endif /* S2C_BRINGUP_H_ */
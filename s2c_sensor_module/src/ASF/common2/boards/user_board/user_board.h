@@ -45,6 +45,17 @@ void system_board_init(void);
 #define AN2						ADC_POSITIVE_INPUT_PIN4
 #define AN3						ADC_POSITIVE_INPUT_PIN5
 
+// Pulse inputs, see s2c_pulse.h. 0 and 1 share the AN1 and AN2 pads
+#define PULSE_0_PIN				PIN_PA03A_EIC_EXTINT3
+#define PULSE_0_MUX				MUX_PA03A_EIC_EXTINT3
+#define PULSE_0_EXTINT			3
+#define PULSE_1_PIN				PIN_PA04A_EIC_EXTINT4
+#define PULSE_1_MUX				MUX_PA04A_EIC_EXTINT4
+#define PULSE_1_EXTINT			4
+#define PULSE_2_PIN				PIN_PA10H_GCLK_IO4
+#define PULSE_2_MUX				MUX_PA10H_GCLK_IO4
+#define PULSE_2_GCLK_GENERATOR	GCLK_GENERATOR_4 // GCLK_IO4 only feeds generator 4
+
 // I2C
 #define I2C_MASTER_MODULE		SERCOM2
 #define I2C_SDA_PIN				PIN_PA08D_SERCOM2_PAD0
@@ -37,7 +37,7 @@
 
 struct adc_module *_adc_instances[ADC_INST_NUM];
 
-static void _adc_interrupt_handler(const uint8_t instance)
+RAMFUNC static void _adc_interrupt_handler(const uint8_t instance)
 {
 	struct adc_module *module = _adc_instances[instance];
 
@@ -94,14 +94,14 @@ static void _adc_interrupt_handler(const uint8_t instance)
 /** Interrupt handler for the ADC module. */
 #if (ADC_INST_NUM > 1) || (SAMC20)
 #   define _ADC_INTERRUPT_HANDLER(n, m) \
-		void ADC##n##_Handler(void) \
+		RAMFUNC void ADC##n##_Handler(void) \
 		{ \
 			_adc_interrupt_handler(n); \
 		}
 
 	MREPEAT(ADC_INST_NUM, _ADC_INTERRUPT_HANDLER, 0)
 #else
-void ADC_Handler(void)
+RAMFUNC void ADC_Handler(void)
 {
 	_adc_interrupt_handler(0);
 }
@@ -177,7 +177,7 @@ void adc_unregister_callback(
  *                          in progress
  * \retval STATUS_BUSY      The ADC is already busy with another job
  */
-enum status_code adc_read_buffer_job(
+RAMFUNC enum status_code adc_read_buffer_job(
 		struct adc_module *const module_inst,
 		uint16_t *buffer,
 		uint16_t samples)
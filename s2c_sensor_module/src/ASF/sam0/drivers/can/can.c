@@ -40,70 +40,144 @@
 /* Instance for GCLK setting. */
 struct system_gclk_chan_config gclk_chan_conf;
 
-/* Message ram definition. */
+/* Message ram definition.
+ * Only instances enabled in conf_can.h get message RAM, and sections
+ * configured with zero elements are not allocated. Each section's start
+ * address for the message RAM configuration registers is 0 when it is
+ * not allocated.
+ */
+#if CONF_CAN0_ENABLE
+#  if CONF_CAN0_RX_BUFFER_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_rx_element_buffer can0_rx_buffer[CONF_CAN0_RX_BUFFER_NUM];
+#    define CAN0_RX_BUFFER_ADDR  ((uint32_t)can0_rx_buffer)
+#  else
+#    define CAN0_RX_BUFFER_ADDR  0
+#  endif
+#  if CONF_CAN0_RX_FIFO_0_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_rx_element_fifo_0 can0_rx_fifo_0[CONF_CAN0_RX_FIFO_0_NUM];
+#    define CAN0_RX_FIFO_0_ADDR  ((uint32_t)can0_rx_fifo_0)
+#  else
+#    define CAN0_RX_FIFO_0_ADDR  0
+#  endif
+#  if CONF_CAN0_RX_FIFO_1_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_rx_element_fifo_1 can0_rx_fifo_1[CONF_CAN0_RX_FIFO_1_NUM];
+#    define CAN0_RX_FIFO_1_ADDR  ((uint32_t)can0_rx_fifo_1)
+#  else
+#    define CAN0_RX_FIFO_1_ADDR  0
+#  endif
 COMPILER_ALIGNED(4)
 static struct can_tx_element can0_tx_buffer[CONF_CAN0_TX_BUFFER_NUM + CONF_CAN0_TX_FIFO_QUEUE_NUM];
+#  if CONF_CAN0_TX_EVENT_FIFO > 0
 COMPILER_ALIGNED(4)
 static struct can_tx_event_element can0_tx_event_fifo[CONF_CAN0_TX_EVENT_FIFO];
+#    define CAN0_TX_EVENT_FIFO_ADDR  ((uint32_t)can0_tx_event_fifo)
+#  else
+#    define CAN0_TX_EVENT_FIFO_ADDR  0
+#  endif
+#  if CONF_CAN0_RX_STANDARD_ID_FILTER_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_standard_message_filter_element can0_rx_standard_filter[CONF_CAN0_RX_STANDARD_ID_FILTER_NUM];
+#    define CAN0_RX_STANDARD_FILTER_ADDR  ((uint32_t)can0_rx_standard_filter)
+#  else
+#    define CAN0_RX_STANDARD_FILTER_ADDR  0
+#  endif
+#  if CONF_CAN0_RX_EXTENDED_ID_FILTER_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_extended_message_filter_element can0_rx_extended_filter[CONF_CAN0_RX_EXTENDED_ID_FILTER_NUM];
-
+#    define CAN0_RX_EXTENDED_FILTER_ADDR  ((uint32_t)can0_rx_extended_filter)
+#  else
+#    define CAN0_RX_EXTENDED_FILTER_ADDR  0
+#  endif
+#endif
+
+#if CONF_CAN1_ENABLE
+#  if CONF_CAN1_RX_BUFFER_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_rx_element_buffer can1_rx_buffer[CONF_CAN1_RX_BUFFER_NUM];
+#    define CAN1_RX_BUFFER_ADDR  ((uint32_t)can1_rx_buffer)
+#  else
+#    define CAN1_RX_BUFFER_ADDR  0
+#  endif
+#  if CONF_CAN1_RX_FIFO_0_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_rx_element_fifo_0 can1_rx_fifo_0[CONF_CAN1_RX_FIFO_0_NUM];
+#    define CAN1_RX_FIFO_0_ADDR  ((uint32_t)can1_rx_fifo_0)
+#  else
+#    define CAN1_RX_FIFO_0_ADDR  0
+#  endif
+#  if CONF_CAN1_RX_FIFO_1_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_rx_element_fifo_1 can1_rx_fifo_1[CONF_CAN1_RX_FIFO_1_NUM];
+#    define CAN1_RX_FIFO_1_ADDR  ((uint32_t)can1_rx_fifo_1)
+#  else
+#    define CAN1_RX_FIFO_1_ADDR  0
+#  endif
 COMPILER_ALIGNED(4)
 static struct can_tx_element can1_tx_buffer[CONF_CAN1_TX_BUFFER_NUM + CONF_CAN1_TX_FIFO_QUEUE_NUM];
+#  if CONF_CAN1_TX_EVENT_FIFO > 0
 COMPILER_ALIGNED(4)
 static struct can_tx_event_element can1_tx_event_fifo[CONF_CAN1_TX_EVENT_FIFO];
+#    define CAN1_TX_EVENT_FIFO_ADDR  ((uint32_t)can1_tx_event_fifo)
+#  else
+#    define CAN1_TX_EVENT_FIFO_ADDR  0
+#  endif
+#  if CONF_CAN1_RX_STANDARD_ID_FILTER_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_standard_message_filter_element can1_rx_standard_filter[CONF_CAN1_RX_STANDARD_ID_FILTER_NUM];
+#    define CAN1_RX_STANDARD_FILTER_ADDR  ((uint32_t)can1_rx_standard_filter)
+#  else
+#    define CAN1_RX_STANDARD_FILTER_ADDR  0
+#  endif
+#  if CONF_CAN1_RX_EXTENDED_ID_FILTER_NUM > 0
 COMPILER_ALIGNED(4)
 static struct can_extended_message_filter_element can1_rx_extended_filter[CONF_CAN1_RX_EXTENDED_ID_FILTER_NUM];
+#    define CAN1_RX_EXTENDED_FILTER_ADDR  ((uint32_t)can1_rx_extended_filter)
+#  else
+#    define CAN1_RX_EXTENDED_FILTER_ADDR  0
+#  endif
+#endif
 
 static void _can_message_memory_init(Can *hw)
 {
+#if CONF_CAN0_ENABLE
 	if (hw == CAN0) {
-		hw->SIDFC.reg = CAN_SIDFC_FLSSA((uint32_t)can0_rx_standard_filter) |
+		hw->SIDFC.reg = CAN_SIDFC_FLSSA(CAN0_RX_STANDARD_FILTER_ADDR) |
 				CAN_SIDFC_LSS(CONF_CAN0_RX_STANDARD_ID_FILTER_NUM);
-		hw->XIDFC.reg = CAN_XIDFC_FLESA((uint32_t)can0_rx_extended_filter) |
+		hw->XIDFC.reg = CAN_XIDFC_FLESA(CAN0_RX_EXTENDED_FILTER_ADDR) |
 				CAN_XIDFC_LSE(CONF_CAN0_RX_EXTENDED_ID_FILTER_NUM);
-		hw->RXF0C.reg = CAN_RXF0C_F0SA((uint32_t)can0_rx_fifo_0) |
+		hw->RXF0C.reg = CAN_RXF0C_F0SA(CAN0_RX_FIFO_0_ADDR) |
 				CAN_RXF0C_F0S(CONF_CAN0_RX_FIFO_0_NUM);
-		hw->RXF1C.reg = CAN_RXF1C_F1SA((uint32_t)can0_rx_fifo_1) |
+		hw->RXF1C.reg = CAN_RXF1C_F1SA(CAN0_RX_FIFO_1_ADDR) |
 				CAN_RXF1C_F1S(CONF_CAN0_RX_FIFO_1_NUM);
-		hw->RXBC.reg = CAN_RXBC_RBSA((uint32_t)can0_rx_buffer);
+		hw->RXBC.reg = CAN_RXBC_RBSA(CAN0_RX_BUFFER_ADDR);
 		hw->TXBC.reg = CAN_TXBC_TBSA((uint32_t)can0_tx_buffer) |
 				CAN_TXBC_NDTB(CONF_CAN0_TX_BUFFER_NUM) |
 				CAN_TXBC_TFQS(CONF_CAN0_TX_FIFO_QUEUE_NUM);
-		hw->TXEFC.reg = CAN_TXEFC_EFSA((uint32_t)can0_tx_event_fifo) |
+		hw->TXEFC.reg = CAN_TXEFC_EFSA(CAN0_TX_EVENT_FIFO_ADDR) |
 				CAN_TXEFC_EFS(CONF_CAN0_TX_EVENT_FIFO);
-	} else if (hw == CAN1) {
-		hw->SIDFC.reg = CAN_SIDFC_FLSSA((uint32_t)can1_rx_standard_filter) |
+	}
+#endif
+#if CONF_CAN1_ENABLE
+	if (hw == CAN1) {
+		hw->SIDFC.reg = CAN_SIDFC_FLSSA(CAN1_RX_STANDARD_FILTER_ADDR) |
 				CAN_SIDFC_LSS(CONF_CAN1_RX_STANDARD_ID_FILTER_NUM);
-		hw->XIDFC.reg = CAN_XIDFC_FLESA((uint32_t)can1_rx_extended_filter) |
+		hw->XIDFC.reg = CAN_XIDFC_FLESA(CAN1_RX_EXTENDED_FILTER_ADDR) |
 				CAN_XIDFC_LSE(CONF_CAN1_RX_EXTENDED_ID_FILTER_NUM);
-		hw->RXF0C.reg = CAN_RXF0C_F0SA((uint32_t)can1_rx_fifo_0) |
+		hw->RXF0C.reg = CAN_RXF0C_F0SA(CAN1_RX_FIFO_0_ADDR) |
 				CAN_RXF0C_F0S(CONF_CAN1_RX_FIFO_0_NUM);
-		hw->RXF1C.reg = CAN_RXF1C_F1SA((uint32_t)can1_rx_fifo_1) |
+		hw->RXF1C.reg = CAN_RXF1C_F1SA(CAN1_RX_FIFO_1_ADDR) |
 				CAN_RXF1C_F1S(CONF_CAN1_RX_FIFO_1_NUM);
-		hw->RXBC.reg = CAN_RXBC_RBSA((uint32_t)can1_rx_buffer);
+		hw->RXBC.reg = CAN_RXBC_RBSA(CAN1_RX_BUFFER_ADDR);
 		hw->TXBC.reg = CAN_TXBC_TBSA((uint32_t)can1_tx_buffer) |
 				CAN_TXBC_NDTB(CONF_CAN1_TX_BUFFER_NUM) |
 				CAN_TXBC_TFQS(CONF_CAN1_TX_FIFO_QUEUE_NUM);
-		hw->TXEFC.reg = CAN_TXEFC_EFSA((uint32_t)can1_tx_event_fifo) |
+		hw->TXEFC.reg = CAN_TXEFC_EFSA(CAN1_TX_EVENT_FIFO_ADDR) |
 				CAN_TXEFC_EFS(CONF_CAN1_TX_EVENT_FIFO);
 	}
+#endif
 
 	/**
 	 * The data size in conf_can.h should be 8/12/16/20/24/32/48/64,
@@ -408,13 +482,18 @@ enum status_code can_set_rx_standard_filter(
 		struct can_module *const module_inst,
 		struct can_standard_message_filter_element *sd_filter, uint32_t index)
 {
-	if (module_inst->hw == CAN0) {
+#if CONF_CAN0_ENABLE && CONF_CAN0_RX_STANDARD_ID_FILTER_NUM > 0
+	if (module_inst->hw == CAN0 && index < CONF_CAN0_RX_STANDARD_ID_FILTER_NUM) {
 		can0_rx_standard_filter[index].S0.reg = sd_filter->S0.reg;
 		return STATUS_OK;
-	} else if (module_inst->hw == CAN1) {
+	}
+#endif
+#if CONF_CAN1_ENABLE && CONF_CAN1_RX_STANDARD_ID_FILTER_NUM > 0
+	if (module_inst->hw == CAN1 && index < CONF_CAN1_RX_STANDARD_ID_FILTER_NUM) {
 		can1_rx_standard_filter[index].S0.reg = sd_filter->S0.reg;
 		return STATUS_OK;
 	}
+#endif
 	return STATUS_ERR_INVALID_ARG;
 }
 
@@ -422,15 +501,20 @@ enum status_code can_set_rx_extended_filter(
 		struct can_module *const module_inst,
 		struct can_extended_message_filter_element *et_filter, uint32_t index)
 {
-	if (module_inst->hw == CAN0) {
+#if CONF_CAN0_ENABLE && CONF_CAN0_RX_EXTENDED_ID_FILTER_NUM > 0
+	if (module_inst->hw == CAN0 && index < CONF_CAN0_RX_EXTENDED_ID_FILTER_NUM) {
 		can0_rx_extended_filter[index].F0.reg = et_filter->F0.reg;
 		can0_rx_extended_filter[index].F1.reg = et_filter->F1.reg;
 		return STATUS_OK;
-	} else if (module_inst->hw == CAN1) {
+	}
+#endif
+#if CONF_CAN1_ENABLE && CONF_CAN1_RX_EXTENDED_ID_FILTER_NUM > 0
+	if (module_inst->hw == CAN1 && index < CONF_CAN1_RX_EXTENDED_ID_FILTER_NUM) {
 		can1_rx_extended_filter[index].F0.reg = et_filter->F0.reg;
 		can1_rx_extended_filter[index].F1.reg = et_filter->F1.reg;
 		return STATUS_OK;
 	}
+#endif
 	return STATUS_ERR_INVALID_ARG;
 }
 
@@ -438,13 +522,18 @@ enum status_code can_get_rx_buffer_element(
 		struct can_module *const module_inst,
 		struct can_rx_element_buffer *rx_element, uint32_t index)
 {
-	if (module_inst->hw == CAN0) {
+#if CONF_CAN0_ENABLE && CONF_CAN0_RX_BUFFER_NUM > 0
+	if (module_inst->hw == CAN0 && index < CONF_CAN0_RX_BUFFER_NUM) {
 		memcpy(rx_element, &can0_rx_buffer[index], sizeof(struct can_rx_element_buffer));
 		return STATUS_OK;
-	} else if (module_inst->hw == CAN1) {
+	}
+#endif
+#if CONF_CAN1_ENABLE && CONF_CAN1_RX_BUFFER_NUM > 0
+	if (module_inst->hw == CAN1 && index < CONF_CAN1_RX_BUFFER_NUM) {
 		memcpy(rx_element, &can1_rx_buffer[index], sizeof(struct can_rx_element_buffer));
 		return STATUS_OK;
 	}
+#endif
 	return STATUS_ERR_INVALID_ARG;
 }
 
@@ -452,13 +541,18 @@ enum status_code can_get_rx_fifo_0_element(
 		struct can_module *const module_inst,
 		struct can_rx_element_fifo_0 *rx_element, uint32_t index)
 {
-	if (module_inst->hw == CAN0) {
+#if CONF_CAN0_ENABLE && CONF_CAN0_RX_FIFO_0_NUM > 0
+	if (module_inst->hw == CAN0 && index < CONF_CAN0_RX_FIFO_0_NUM) {
 		memcpy(rx_element, &can0_rx_fifo_0[index], sizeof(struct can_rx_element_buffer));
 		return STATUS_OK;
-	} else if (module_inst->hw == CAN1) {
+	}
+#endif
+#if CONF_CAN1_ENABLE && CONF_CAN1_RX_FIFO_0_NUM > 0
+	if (module_inst->hw == CAN1 && index < CONF_CAN1_RX_FIFO_0_NUM) {
 		memcpy(rx_element, &can1_rx_fifo_0[index], sizeof(struct can_rx_element_buffer));
 		return STATUS_OK;
 	}
+#endif
 	return STATUS_ERR_INVALID_ARG;
 }
 
@@ -466,13 +560,18 @@ enum status_code can_get_rx_fifo_1_element(
 		struct can_module *const module_inst,
 		struct can_rx_element_fifo_1 *rx_element, uint32_t index)
 {
-	if (module_inst->hw == CAN0) {
+#if CONF_CAN0_ENABLE && CONF_CAN0_RX_FIFO_1_NUM > 0
+	if (module_inst->hw == CAN0 && index < CONF_CAN0_RX_FIFO_1_NUM) {
 		memcpy(rx_element, &can0_rx_fifo_1[index], sizeof(struct can_rx_element_buffer));
 		return STATUS_OK;
-	} else if (module_inst->hw == CAN1) {
+	}
+#endif
+#if CONF_CAN1_ENABLE && CONF_CAN1_RX_FIFO_1_NUM > 0
+	if (module_inst->hw == CAN1 && index < CONF_CAN1_RX_FIFO_1_NUM) {
 		memcpy(rx_element, &can1_rx_fifo_1[index], sizeof(struct can_rx_element_buffer));
 		return STATUS_OK;
 	}
+#endif
 	return STATUS_ERR_INVALID_ARG;
 }
 
@@ -481,14 +580,18 @@ enum status_code can_set_tx_buffer_element(
 		struct can_tx_element *tx_element, uint32_t index)
 {
 	uint32_t i;
-	if (module_inst->hw == CAN0) {
+#if CONF_CAN0_ENABLE
+	if (module_inst->hw == CAN0 && index < CONF_CAN0_TX_BUFFER_NUM + CONF_CAN0_TX_FIFO_QUEUE_NUM) {
 		can0_tx_buffer[index].T0.reg = tx_element->T0.reg;
 		can0_tx_buffer[index].T1.reg = tx_element->T1.reg;
 		for (i = 0; i < CONF_CAN_ELEMENT_DATA_SIZE; i++) {
 			can0_tx_buffer[index].data[i] = tx_element->data[i];
 		}
 		return STATUS_OK;
-	} else if (module_inst->hw == CAN1) {
+	}
+#endif
+#if CONF_CAN1_ENABLE
+	if (module_inst->hw == CAN1 && index < CONF_CAN1_TX_BUFFER_NUM + CONF_CAN1_TX_FIFO_QUEUE_NUM) {
 		can1_tx_buffer[index].T0.reg = tx_element->T0.reg;
 		can1_tx_buffer[index].T1.reg = tx_element->T1.reg;
 		for (i = 0; i < CONF_CAN_ELEMENT_DATA_SIZE; i++) {
@@ -496,22 +599,46 @@ enum status_code can_set_tx_buffer_element(
 		}
 		return STATUS_OK;
 	}
+#endif
 	return STATUS_ERR_INVALID_ARG;
 }
 
+struct can_tx_element *can_get_tx_buffer_element_address(
+		struct can_module *const module_inst, uint32_t index)
+{
+#if CONF_CAN0_ENABLE
+	if (module_inst->hw == CAN0 &&
+			index < CONF_CAN0_TX_BUFFER_NUM + CONF_CAN0_TX_FIFO_QUEUE_NUM) {
+		return &can0_tx_buffer[index];
+	}
+#endif
+#if CONF_CAN1_ENABLE
+	if (module_inst->hw == CAN1 &&
+			index < CONF_CAN1_TX_BUFFER_NUM + CONF_CAN1_TX_FIFO_QUEUE_NUM) {
+		return &can1_tx_buffer[index];
+	}
+#endif
+	return NULL;
+}
+
 enum status_code can_get_tx_event_fifo_element(
 		struct can_module *const module_inst,
 		struct can_tx_event_element *tx_event_element, uint32_t index)
 {
-	if (module_inst->hw == CAN0) {
+#if CONF_CAN0_ENABLE && CONF_CAN0_TX_EVENT_FIFO > 0
+	if (module_inst->hw == CAN0 && index < CONF_CAN0_TX_EVENT_FIFO) {
 		tx_event_element->E0.reg = can0_tx_event_fifo[index].E0.reg;
 		tx_event_element->E1.reg = can0_tx_event_fifo[index].E1.reg;
 		return STATUS_OK;
-	} else if (module_inst->hw == CAN1) {
+	}
+#endif
+#if CONF_CAN1_ENABLE && CONF_CAN1_TX_EVENT_FIFO > 0
+	if (module_inst->hw == CAN1 && index < CONF_CAN1_TX_EVENT_FIFO) {
 		tx_event_element->E0.reg = can1_tx_event_fifo[index].E0.reg;
 		tx_event_element->E1.reg = can1_tx_event_fifo[index].E1.reg;
 		return STATUS_OK;
 	}
+#endif
 	return STATUS_ERR_INVALID_ARG;
 }
 
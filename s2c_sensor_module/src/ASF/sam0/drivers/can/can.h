@@ -1178,6 +1178,22 @@ enum status_code can_set_tx_buffer_element(
 		struct can_module *const module_inst,
 		struct can_tx_element *tx_element, uint32_t index);
 
+/**
+ * \brief Get the address of a transfer buffer element in message RAM.
+ *
+ * Lets the application build a frame in place instead of copying it in with
+ * \ref can_set_tx_buffer_element(). The element must not be written while
+ * its transmission request is pending, see \ref can_tx_get_pending_status().
+ *
+ * \param[in] module_inst  Pointer to the CAN software instance struct
+ * \param[in] index  Index for the transfer buffer
+ *
+ *  \return Pointer to the transfer buffer element, or NULL if the parameters
+ *          are not correct.
+ */
+struct can_tx_element *can_get_tx_buffer_element_address(
+		struct can_module *const module_inst, uint32_t index);
+
 /**
  * \brief Get the pointer to the transfer event FIFO element.
  *
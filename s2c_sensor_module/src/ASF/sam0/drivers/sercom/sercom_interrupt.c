@@ -34,6 +34,7 @@
  * Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
  */
 #include "sercom_interrupt.h"
+#include <s2c_irq.h>
 
 void *_sercom_instances[SERCOM_INST_NUM];
 
@@ -89,11 +90,14 @@ void _sercom_set_handler(
 
 /** \internal
  * Generates a SERCOM interrupt handler function for a given SERCOM index.
+ * Instrumented as IRQ_SOURCE_SERCOM (s2c_irq.h), only SERCOM2 (I2C) is in use.
  */
 #define _SERCOM_INTERRUPT_HANDLER(n, unused) \
 		void SERCOM##n##_Handler(void) \
 		{ \
+			uint32_t entry = irq_enter(); \
 			_sercom_interrupt_handlers[n](n); \
+			irq_exit(IRQ_SOURCE_SERCOM, entry); \
 		}
 
 /**
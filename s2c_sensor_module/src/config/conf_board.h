@@ -36,4 +36,46 @@
 
 #define USE_PINSTRAPS		true
 
+// Samples the suspension at a fixed rate and sends it low-pass filtered and decimated (wheel boards only)
+#define USE_WHEEL_FILTER	false
+
+// Samples the suspension at a fixed rate and sends its band energies (wheel boards only)
+#define USE_WHEEL_ANALYSIS	false
+
+// Captures the suspension around bump and curb strikes and drains it over CAN (wheel boards only)
+#define USE_WHEEL_CAPTURE	false
+
+// Measures wheel speed from a toothed ring sensor on the AN1 pad (wheel boards only)
+#define USE_WHEEL_SPEED		false
+#define WHEEL_SPEED_TEETH			24		// sensor pulses per wheel turn
+#define WHEEL_CIRCUMFERENCE_MM		1600	// rolling circumference
+
+// Sends min/max/mean/RMS per SUMMARY_WINDOW_MS instead of every value (radiator boards only)
+#define USE_RADIATOR_SUMMARY	false
+
+// Sends worst-case interrupt latency and duration as debug frames (any board)
+#define USE_IRQ_REPORT		false
+
+// Keeps a trace of the last branches for a dump over CAN after a hard fault or watchdog reset (any board)
+#define USE_MTB_TRACE		false
+
+// Measures CAN throughput and latency in internal loopback at boot, then sends the results (any board)
+#define USE_CAN_BENCH		false
+
+// Clocks CAN from the DPLL locked to the 12 MHz crystal instead of the RC oscillator (boards with the crystal fitted)
+#define USE_XOSC_CAN_CLOCK	false
+
+// Radiator NTC thermistors (beta, resistance at 25 deg C) and the pull-up each sits under
+#define RADIATOR_THERM_BETA			3435
+#define RADIATOR_THERM_R25_OHM		10000
+#define RADIATOR_THERM_PULLUP_OHM	10000
+
+// Pulse inputs on the radiator board (fan tach, pump, flow meter), see s2c_pulse.h.
+// Bit 1: AN2 pad, period. Bit 2: PA10, FREQM. Not bit 0, its AN1 pad is the outlet thermistor
+#define RADIATOR_PULSE_MASK			0x0
+
+// Sends an alarm frame within microseconds when the radiator inlet passes RADIATOR_ALARM_CENTI_C (radiator boards only)
+#define USE_RADIATOR_ALARM			false
+#define RADIATOR_ALARM_CENTI_C		11000
+
 #endif // CONF_BOARD_H
@@ -39,58 +39,126 @@
 /*
  * Below is the message RAM setting, it will be stored in the system RAM.
  * Please adjust the message size according to your application.
+ *
+ * Message RAM is only reserved for enabled instances, and sections set to
+ * 0 elements are not reserved at all. The sensor module only uses CAN0, to
+ * send from dedicated TX buffers:
+ *  \li 0: frame 1 / summary frames
+ *  \li 1: analysis bands
+ *  \li 2, 3: capture drain
+ *  \li 4: debug frames and command replies
+ *  \li 5: pulse input frequencies
+ *  \li 6: alarm frames
+ * and receives its command channel (s2c_nvm.h) through one standard filter
+ * into RX FIFO 0. CAN1, the other RX sections, the TX FIFO/queue and the TX
+ * event FIFO are all off.
+ * Raise the sizes here when a feature starts using them.
  */
-#define CONF_CAN0_RX_FIFO_0_NUM         16            /* Range: 1..64 */ 
-#define CONF_CAN0_RX_FIFO_1_NUM         16            /* Range: 1..64 */ 
-#define CONF_CAN0_RX_BUFFER_NUM         16            /* Range: 1..64 */ 
-#define CONF_CAN0_TX_BUFFER_NUM         4             /* Range: 1..16 */ 
-#define CONF_CAN0_TX_FIFO_QUEUE_NUM     4             /* Range: 1..16 */ 
-#define CONF_CAN0_TX_EVENT_FIFO         8             /* Range: 1..32 */ 
-
-#define CONF_CAN0_RX_STANDARD_ID_FILTER_NUM     32    /* Range: 1..128 */ 
-#define CONF_CAN0_RX_EXTENDED_ID_FILTER_NUM     16    /* Range: 1..64 */ 
-
-#define CONF_CAN1_RX_FIFO_0_NUM         16            /* Range: 1..64 */ 
-#define CONF_CAN1_RX_FIFO_1_NUM         16            /* Range: 1..64 */ 
-#define CONF_CAN1_RX_BUFFER_NUM         16            /* Range: 1..64 */ 
-#define CONF_CAN1_TX_BUFFER_NUM         4             /* Range: 1..16 */ 
-#define CONF_CAN1_TX_FIFO_QUEUE_NUM     4             /* Range: 1..16 */ 
-#define CONF_CAN1_TX_EVENT_FIFO         8             /* Range: 1..32 */ 
-
-#define CONF_CAN1_RX_STANDARD_ID_FILTER_NUM     32    /* Range: 1..128 */ 
-#define CONF_CAN1_RX_EXTENDED_ID_FILTER_NUM     16    /* Range: 1..64 */ 
+#define CONF_CAN0_ENABLE                true
+#define CONF_CAN1_ENABLE                false
+
+#define CONF_CAN0_RX_FIFO_0_NUM         4             /* Range: 0..64 */ 
+#define CONF_CAN0_RX_FIFO_1_NUM         0             /* Range: 0..64 */ 
+#define CONF_CAN0_RX_BUFFER_NUM         0             /* Range: 0..64 */ 
+#define CONF_CAN0_TX_BUFFER_NUM         7             /* Range: 0..32 */ 
+#define CONF_CAN0_TX_FIFO_QUEUE_NUM     0             /* Range: 0..32, 1..32 with the TX buffers */ 
+#define CONF_CAN0_TX_EVENT_FIFO         0             /* Range: 0..32 */ 
+
+#define CONF_CAN0_RX_STANDARD_ID_FILTER_NUM     1     /* Range: 0..128 */ 
+#define CONF_CAN0_RX_EXTENDED_ID_FILTER_NUM     0     /* Range: 0..64 */ 
+
+#define CONF_CAN1_RX_FIFO_0_NUM         16            /* Range: 0..64 */ 
+#define CONF_CAN1_RX_FIFO_1_NUM         16            /* Range: 0..64 */ 
+#define CONF_CAN1_RX_BUFFER_NUM         16            /* Range: 0..64 */ 
+#define CONF_CAN1_TX_BUFFER_NUM         4             /* Range: 0..32 */ 
+#define CONF_CAN1_TX_FIFO_QUEUE_NUM     4             /* Range: 0..32, 1..32 with the TX buffers */ 
+#define CONF_CAN1_TX_EVENT_FIFO         8             /* Range: 0..32 */ 
+
+#define CONF_CAN1_RX_STANDARD_ID_FILTER_NUM     32    /* Range: 0..128 */ 
+#define CONF_CAN1_RX_EXTENDED_ID_FILTER_NUM     16    /* Range: 0..64 */ 
 
 /* The value should be 8/12/16/20/24/32/48/64. */
-#define CONF_CAN_ELEMENT_DATA_SIZE         8
+/* 64 in the FD profiles, so the CAN benchmark (USE_CAN_BENCH) reaches the FD payload sizes */
+#define CONF_CAN_ELEMENT_DATA_SIZE         (CONF_CAN_FD_ENABLE ? 64 : 8)
 
 /*
- * The setting of the nominal bit rate is based on the GCLK_CAN is 48M which you can
- * change in the conf_clock.h. Below is the default configuration. The
- * time quanta is 48MHz / (5+1) =  8MHz. And each bit is (3+10+3) = 16 time
- * quanta which means the bit rate is 8MHz / 16 = 500KHz.
+ * Bit timing. The prescalers and segments are worked out at build time from
+ * the GCLK_CAN frequency in conf_clocks.h (generator 8, see
+ * can_get_config_defaults(), fed by OSC48M or the DPLL at the same
+ * frequency, see s2c_clock.h), the bitrates and the sample points of the
+ * profile below. A profile the clock can't reach stops the build.
  */
+#include <conf_clocks.h>
+#include <s2c_can_timing.h>
+
+#define CAN_PROFILE_500K            0 /* Classic CAN, 500 kbit/s */
+#define CAN_PROFILE_1M              1 /* Classic CAN, 1 Mbit/s */
+#define CAN_PROFILE_1M_FD_2M        2 /* CAN FD, 1 Mbit/s arbitration, 2 Mbit/s data */
+#define CAN_PROFILE_1M_FD_4M        3 /* CAN FD, 1 Mbit/s arbitration, 4 Mbit/s data. Needs GCLK_CAN >= 20 MHz */
+
+/* Every node on the bus has to run the same profile */
+#define CONF_CAN_PROFILE            CAN_PROFILE_500K
+
+#if CONF_CAN_PROFILE == CAN_PROFILE_500K
+#  define CONF_CAN_FD_ENABLE        false
+#  define CONF_CAN_NOMINAL_BITRATE  500000UL
+#  define CONF_CAN_DATA_BITRATE     500000UL
+#elif CONF_CAN_PROFILE == CAN_PROFILE_1M
+#  define CONF_CAN_FD_ENABLE        false
+#  define CONF_CAN_NOMINAL_BITRATE  1000000UL
+#  define CONF_CAN_DATA_BITRATE     1000000UL
+#elif CONF_CAN_PROFILE == CAN_PROFILE_1M_FD_2M
+#  define CONF_CAN_FD_ENABLE        true
+#  define CONF_CAN_NOMINAL_BITRATE  1000000UL
+#  define CONF_CAN_DATA_BITRATE     2000000UL
+#elif CONF_CAN_PROFILE == CAN_PROFILE_1M_FD_4M
+#  define CONF_CAN_FD_ENABLE        true
+#  define CONF_CAN_NOMINAL_BITRATE  1000000UL
+#  define CONF_CAN_DATA_BITRATE     4000000UL
+#else
+#  error "Unknown CONF_CAN_PROFILE"
+#endif
+
+/* Sample points in per mille, as recommended by CiA 601 */
+#define CONF_CAN_NOMINAL_SAMPLE_POINT   875
+#define CONF_CAN_DATA_SAMPLE_POINT      750
+
+#define CONF_CAN_GCLK_HZ            (48000000UL / (CONF_CLOCK_OSC48M_FREQ_DIV + 1) / CONF_CLOCK_GCLK_8_PRESCALER)
+
+/*
+ * 8 to 25 time quanta per nominal bit. The data phase may go down to 5,
+ * fewer leave too little phase segment to resynchronise on a real harness.
+ */
+#define CONF_CAN_NOMINAL_BRP        S2C_CAN_BRP(CONF_CAN_GCLK_HZ, CONF_CAN_NOMINAL_BITRATE, 8, 25)
+#define CONF_CAN_NOMINAL_TQ         S2C_CAN_TQ(CONF_CAN_GCLK_HZ, CONF_CAN_NOMINAL_BITRATE, CONF_CAN_NOMINAL_BRP)
+#define CONF_CAN_DATA_BRP           S2C_CAN_BRP(CONF_CAN_GCLK_HZ, CONF_CAN_DATA_BITRATE, 5, 25)
+#define CONF_CAN_DATA_TQ            S2C_CAN_TQ(CONF_CAN_GCLK_HZ, CONF_CAN_DATA_BITRATE, CONF_CAN_DATA_BRP)
+
+_Static_assert(S2C_CAN_TIMING_VALID(CONF_CAN_NOMINAL_TQ, CONF_CAN_NOMINAL_SAMPLE_POINT, 256, 128),
+		"CAN nominal bitrate / sample point can't be reached from GCLK_CAN");
+_Static_assert(S2C_CAN_TIMING_VALID(CONF_CAN_DATA_TQ, CONF_CAN_DATA_SAMPLE_POINT, 32, 16),
+		"CAN data bitrate / sample point can't be reached from GCLK_CAN");
+
+/* Register values, each field holds its length minus 1 */
 /* Nominal bit Baud Rate Prescaler */
-#define CONF_CAN_NBTP_NBRP_VALUE    5
+#define CONF_CAN_NBTP_NBRP_VALUE    (CONF_CAN_NOMINAL_BRP - 1)
 /* Nominal bit (Re)Synchronization Jump Width */
-#define CONF_CAN_NBTP_NSJW_VALUE    3
+#define CONF_CAN_NBTP_NSJW_VALUE    (S2C_CAN_SJW(CONF_CAN_NOMINAL_TQ, CONF_CAN_NOMINAL_SAMPLE_POINT, 128) - 1)
 /* Nominal bit Time segment before sample point */
-#define CONF_CAN_NBTP_NTSEG1_VALUE  10
+#define CONF_CAN_NBTP_NTSEG1_VALUE  (S2C_CAN_TSEG1(CONF_CAN_NOMINAL_TQ, CONF_CAN_NOMINAL_SAMPLE_POINT) - 1)
 /* Nominal bit Time segment after sample point */
-#define CONF_CAN_NBTP_NTSEG2_VALUE  3
+#define CONF_CAN_NBTP_NTSEG2_VALUE  (S2C_CAN_TSEG2(CONF_CAN_NOMINAL_TQ, CONF_CAN_NOMINAL_SAMPLE_POINT) - 1)
 
-/*
- * The setting of the data bit rate is based on the GCLK_CAN is 48M which you can
- * change in the conf_clock.h. Below is the default configuration. The
- * time quanta is 48MHz / (5+1) =  8MHz. And each bit is (3+10+3) = 16 time
- * quanta which means the bit rate is 8MHz / 16 = 500KHz.
- */
 /* Data bit Baud Rate Prescaler */
-#define CONF_CAN_DBTP_DBRP_VALUE    5
+#define CONF_CAN_DBTP_DBRP_VALUE    (CONF_CAN_DATA_BRP - 1)
 /* Data bit (Re)Synchronization Jump Width */
-#define CONF_CAN_DBTP_DSJW_VALUE    3
+#define CONF_CAN_DBTP_DSJW_VALUE    (S2C_CAN_SJW(CONF_CAN_DATA_TQ, CONF_CAN_DATA_SAMPLE_POINT, 16) - 1)
 /* Data bit Time segment before sample point */
-#define CONF_CAN_DBTP_DTSEG1_VALUE  10
+#define CONF_CAN_DBTP_DTSEG1_VALUE  (S2C_CAN_TSEG1(CONF_CAN_DATA_TQ, CONF_CAN_DATA_SAMPLE_POINT) - 1)
 /* Data bit Time segment after sample point */
-#define CONF_CAN_DBTP_DTSEG2_VALUE  3
+#define CONF_CAN_DBTP_DTSEG2_VALUE  (S2C_CAN_TSEG2(CONF_CAN_DATA_TQ, CONF_CAN_DATA_SAMPLE_POINT) - 1)
+
+/* Transmitter delay compensation offset: the data sample point, in GCLK_CAN periods */
+#define CONF_CAN_TDC_OFFSET         (CONF_CAN_DATA_BRP * (1 + S2C_CAN_TSEG1(CONF_CAN_DATA_TQ, CONF_CAN_DATA_SAMPLE_POINT)))
 
 #endif
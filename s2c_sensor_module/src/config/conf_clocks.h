@@ -40,7 +40,7 @@
 #  define CONF_CLOCK_CPU_DIVIDER                  SYSTEM_MAIN_CLOCK_DIV_1
 
 /* SYSTEM_CLOCK_SOURCE_OSC48M configuration - Internal 48MHz oscillator */
-#  define CONF_CLOCK_OSC48M_FREQ_DIV              SYSTEM_OSC48M_DIV_3
+#  define CONF_CLOCK_OSC48M_FREQ_DIV              SYSTEM_OSC48M_DIV_1
 #  define CONF_CLOCK_OSC48M_ON_DEMAND             true
 #  define CONF_CLOCK_OSC48M_RUN_IN_STANDBY        false
 
@@ -108,18 +108,20 @@
  * false, none of the GCLK generators will be configured in clocks_init(). */
 #  define CONF_CLOCK_CONFIGURE_GCLK               true
 
-/* Configure GCLK generator 0 (Main Clock) */
+/* Configure GCLK generator 0 (Main Clock). Boots at 16 MHz, s2c_clock.c sets
+ * the board's profile, see s2c_clock.h */
 #  define CONF_CLOCK_GCLK_0_ENABLE                true
 #  define CONF_CLOCK_GCLK_0_RUN_IN_STANDBY        false
 #  define CONF_CLOCK_GCLK_0_CLOCK_SOURCE          SYSTEM_CLOCK_SOURCE_OSC48M
-#  define CONF_CLOCK_GCLK_0_PRESCALER             1
+#  define CONF_CLOCK_GCLK_0_PRESCALER             3
 #  define CONF_CLOCK_GCLK_0_OUTPUT_ENABLE         false
 
-/* Configure GCLK generator 1 */
-#  define CONF_CLOCK_GCLK_1_ENABLE                false
+/* Configure GCLK generator 1. 1 MHz timebase for the pulse inputs, the same in
+ * every clock profile, see s2c_pulse.h */
+#  define CONF_CLOCK_GCLK_1_ENABLE                true
 #  define CONF_CLOCK_GCLK_1_RUN_IN_STANDBY        false
 #  define CONF_CLOCK_GCLK_1_CLOCK_SOURCE          SYSTEM_CLOCK_SOURCE_OSC48M
-#  define CONF_CLOCK_GCLK_1_PRESCALER             1
+#  define CONF_CLOCK_GCLK_1_PRESCALER             48
 #  define CONF_CLOCK_GCLK_1_OUTPUT_ENABLE         false
 
 /* Configure GCLK generator 2  */
@@ -164,7 +166,7 @@
 #  define CONF_CLOCK_GCLK_7_PRESCALER             1
 #  define CONF_CLOCK_GCLK_7_OUTPUT_ENABLE         false
 
-/* Configure GCLK generator 8 */
+/* Configure GCLK generator 8 (GCLK_CAN, 48 MHz in every clock profile) */
 #  define CONF_CLOCK_GCLK_8_ENABLE                true
 #  define CONF_CLOCK_GCLK_8_RUN_IN_STANDBY        false
 #  define CONF_CLOCK_GCLK_8_CLOCK_SOURCE          SYSTEM_CLOCK_SOURCE_OSC48M
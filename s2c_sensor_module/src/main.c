@@ -29,6 +29,20 @@
  */
 #include <asf.h>
 #include <s2c_utils.h>
+#include <s2c_filter.h>
+#include <s2c_sampler.h>
+#include <s2c_analysis.h>
+#include <s2c_capture.h>
+#include <s2c_irq.h>
+#include <s2c_trace.h>
+#include <s2c_log.h>
+#include <s2c_can_health.h>
+#include <s2c_clock.h>
+#include <s2c_nvm.h>
+#include <s2c_adc_cal.h>
+#include <s2c_pulse.h>
+#include <s2c_alarm.h>
+#include <s2c_can_bench.h>
 
 // Function prototypes
 uint8_t get_pinstrap_id(void);
@@ -39,15 +53,34 @@ void configure_can(void);
 void configure_i2c(void);
 
 void adc_callback(struct adc_module *const module);
+void adc_start_channel_job(void);
+bool alarm_send(uint8_t channel, bool tripped, uint16_t value);
 
 void loop_adc(void);
 void loop_i2c(void);
 void loop_can(void);
+void loop_sampler(void);
+void loop_can_analysis(void);
+void loop_can_capture(void);
+void loop_can_filter(void);
+void summary_add_scan(void);
+void loop_can_summary(uint8_t num_signals);
+void loop_can_irq_report(void);
+void loop_can_trace(void);
+void loop_can_log(void);
+void loop_can_bench(void);
+void loop_can_health(void);
+void loop_can_command(void);
+void loop_can_pulse(void);
+struct can_tx_element *claim_tx_buffer(uint32_t index);
+void send_tx_buffer(struct can_tx_element *tx_elem, uint32_t index);
 
 // Board management variables
 uint8_t board_id = 255;
 enum s2c_board_type board_type = S2C_BOARD_OTHER;
 struct s2c_board_config board_config;
+uint16_t loop_period_ms = LOOP_PERIOD_MS;
+struct s2c_rate_state rate_state;
 
 // ASF driver instances
 struct adc_module adc_instance;
@@ -57,9 +90,17 @@ struct i2c_master_module i2c_instance;
 // ADC variables
 uint16_t adc_sample_buffer[ADC_NUM_SAMPLES] = {0}; // stores single channel conversion samples
 uint32_t adc_channel[ADC_NUM_CHANNELS] = {AN0, AN1, AN2, AN3}; // stores ADC input pins in the order that they will be read
-uint16_t adc_channel_vals[ADC_NUM_CHANNELS] = {0}; // stores the final averaged value of each channel's conversion
-uint8_t adc_channel_index = 0; // index of current channel being read
-bool adc_section_done = false; // true when all adc cannels have been read
+uint16_t adc_channel_vals[ADC_NUM_CHANNELS] = {0}; // main loop's copy of the latest averaged value of each channel
+volatile uint8_t adc_channel_index = 0; // index of current channel being read
+// One scan of all channels, each averaged over ADC_NUM_SAMPLES
+struct adc_scan {
+	uint16_t vals[ADC_NUM_CHANNELS];
+};
+static struct adc_scan adc_scans[ADC_SCAN_RING_SLOTS];
+struct s2c_ring adc_scan_ring; // completed scans of all channels, the ADC fills them, main loop consumes
+struct adc_scan *volatile adc_scan_fill = NULL; // ring slot the running scan fills, NULL while the ADC is idle
+uint32_t adc_scan_overruns = 0; // scans started late because the main loop fell behind
+bool adc_section_done = false; // true when the main loop has taken a new scan
 
 // I2C variables
 struct i2c_master_packet wr_packet, rd_packet;
@@ -74,6 +115,32 @@ enum status_code i2c_status_code;
 // CAN variables
 //TODO
 bool can_received = false;
+#if !CAN_ZERO_COPY_TX
+static struct can_tx_element can_tx_staging; // frame being built, copied into message RAM on send
+#endif
+static struct can_tx_element *can_alarm_elem; // alarm buffer's element in message RAM, written by alarm_send()
+struct s2c_cov_state can_cov_state; // change-of-value state of frame 1
+static const struct s2c_bitpack_signal wheel_frame_layout[] = S2C_WHEEL_FRAME_LAYOUT;
+static const struct s2c_bitpack_signal tire_temp_frame_layout[] = S2C_TIRE_TEMP_FRAME_LAYOUT;
+static const struct s2c_bitpack_signal radiator_frame_layout[] = S2C_RADIATOR_FRAME_LAYOUT;
+// ADC counts to 0.01 deg C, worked out by the compiler
+static const int16_t radiator_therm_table[] = S2C_THERM_TABLE(1 << ADC_RESULT_BITS, RADIATOR_THERM_BETA,
+	RADIATOR_THERM_R25_OHM, RADIATOR_THERM_PULLUP_OHM);
+
+// Radiator frame 1 signal: 0.01 deg C, offset so it stays unsigned
+static inline uint16_t radiator_signal(uint16_t adc_val) {
+	return s2c_therm_lookup(radiator_therm_table, adc_val, ADC_RESULT_BITS) - S2C_THERM_CENTI_C_MIN;
+}
+
+// Summary variables
+struct s2c_stats summary_stats[COV_MAX_SIGNALS];
+struct s2c_stats_result summary_results[COV_MAX_SIGNALS];
+uint16_t summary_elapsed_ms = 0;
+uint8_t summary_pending = 0; // number of summary frames still to be sent from summary_results
+
+// Interrupt statistics report variables
+uint16_t irq_report_elapsed_ms = 0;
+uint8_t irq_report_pending = 0; // number of sources still to be reported this period
 
 
 /**
@@ -119,6 +186,21 @@ void configure_adc(void) {
 	config.positive_input  = ADC_POSITIVE_INPUT_PIN5;
 	config.resolution      = ADC_RESOLUTION_10BIT;
 	
+	// Gain and offset correction in hardware, from the NVM record or calibrated now and saved there
+	if(nvm_get(NVM_FIELD_ADC_GAIN_CORR) != NVM_UNSET && nvm_get(NVM_FIELD_ADC_OFFSET_CORR) != NVM_UNSET) {
+		config.correction.correction_enable = true;
+		config.correction.gain_correction = nvm_get(NVM_FIELD_ADC_GAIN_CORR);
+		// OFFSETCORR is 12-bit two's complement
+		config.correction.offset_correction = (int16_t)(nvm_get(NVM_FIELD_ADC_OFFSET_CORR) << 4) >> 4;
+	} else {
+		adc_init(&adc_instance, ADC0, &config);
+		if(adc_cal_run(&adc_instance, &config, &config.correction)) {
+			nvm_set(NVM_FIELD_ADC_GAIN_CORR, config.correction.gain_correction);
+			nvm_set(NVM_FIELD_ADC_OFFSET_CORR, config.correction.offset_correction & 0xFFF);
+			nvm_save();
+		}
+	}
+	
 	adc_init(&adc_instance, ADC0, &config);
 	
 	adc_enable(&adc_instance);
@@ -157,9 +239,29 @@ void configure_can(void) {
 	/* Initialize the module. */
 	struct can_config config_can;
 	can_get_config_defaults(&config_can);
+#if CONF_CAN_FD_ENABLE
+	config_can.tdc_enable = true;
+	config_can.delay_compensation_offset = CONF_CAN_TDC_OFFSET;
+#endif
 	can_init(&can_instance, CAN_MODULE, &config_can);
+	// The bit timing in conf_can.h was worked out for this clock
+	Assert(system_gclk_chan_get_hz(CAN0_GCLK_ID) == CONF_CAN_GCLK_HZ);
+#if CONF_CAN_FD_ENABLE
+	can_enable_fd_mode(&can_instance);
+#endif
+
+	// Only the command channel is received, everything else is rejected by the global filter
+	struct can_standard_message_filter_element command_filter;
+	can_get_standard_message_filter_element_default(&command_filter);
+	command_filter.S0.reg = CAN_STANDARD_MESSAGE_FILTER_ELEMENT_S0_SFID2(0x7FF) |
+		CAN_STANDARD_MESSAGE_FILTER_ELEMENT_S0_SFID1(CAN_MSG_ID(board_id, CAN_MSG_COMMAND)) |
+		CAN_STANDARD_MESSAGE_FILTER_ELEMENT_S0_SFEC(CAN_STANDARD_MESSAGE_FILTER_ELEMENT_S0_SFEC_STF0M_Val) |
+		CAN_STANDARD_MESSAGE_FILTER_ELEMENT_S0_SFT_CLASSIC;
+	can_set_rx_standard_filter(&can_instance, &command_filter, 0);
+	can_alarm_elem = can_get_tx_buffer_element_address(&can_instance, CAN_TX_BUFFER_ALARM);
 
 	can_start(&can_instance);
+	can_health_init(&can_instance);
 
 	/* Enable interrupts for this CAN module */
 	system_interrupt_enable(SYSTEM_INTERRUPT_MODULE_CAN0);
@@ -177,34 +279,83 @@ void configure_can(void) {
 
 // Callback functions
 
-void adc_callback(struct adc_module *const module) {
-	// Average all samples and store value in channel's buffer
-	adc_channel_vals[adc_channel_index] = 0;
+RAMFUNC void adc_callback(struct adc_module *const module) {
+	uint32_t entry = irq_enter();
+	
+	// Average all samples and store value in the scan
+	uint32_t sum = 0;
 	for(int i = 0; i < ADC_NUM_SAMPLES; i++) {
-		adc_channel_vals[adc_channel_index] += adc_sample_buffer[i];	
+		sum += adc_sample_buffer[i];	
 	}
-	adc_channel_vals[adc_channel_index] >>= ADC_SAMPLE_DIV;
+	adc_scan_fill->vals[adc_channel_index] = sum >> ADC_SAMPLE_DIV;
 	
 	// If there are still more channels to process, then set up next channel and start the sampling
 	if(adc_channel_index < board_config.adc_channels - 1) {
 		++adc_channel_index;
-		adc_set_positive_input(&adc_instance, adc_channel[adc_channel_index]);
-		adc_read_buffer_job(&adc_instance, adc_sample_buffer, ADC_NUM_SAMPLES);
+		adc_start_channel_job();
 		
 	} else {
-		adc_section_done = true;
+		// Only now does the main loop see the scan
+		s2c_ring_commit(&adc_scan_ring);
+		adc_scan_fill = NULL;
 		adc_channel_index = 0;
+		alarm_watch(); // the ADC is idle until the next scan
 	}
+	irq_exit(IRQ_SOURCE_ADC, entry);
+}
+
+/**
+ * \brief Starts the buffer job for the current ADC channel
+ */
+RAMFUNC void adc_start_channel_job(void) {
+	adc_set_positive_input(&adc_instance, adc_channel[adc_channel_index]);
+	adc_read_buffer_job(&adc_instance, adc_sample_buffer, ADC_NUM_SAMPLES);
 }
 
 // Loop functions
 
 void loop_adc(void) {
-	// Make sure this is the start of a sequence, and not in the middle of one
-	if(adc_channel_index == 0) {
-		adc_set_positive_input(&adc_instance, adc_channel[adc_channel_index]);
-		adc_read_buffer_job(&adc_instance, adc_sample_buffer, ADC_NUM_SAMPLES);
+	// In filter, analysis and capture mode the sampler owns the ADC
+	if(board_config.use_filter || board_config.use_analysis || board_config.use_capture) {
+		loop_sampler();
+		return;
 	}
+	
+	// Start a scan unless one is running. It fills a ring slot of its own, so it
+	// waits for a free one if the main loop hasn't taken the older scans yet
+	if(adc_scan_fill == NULL) {
+		adc_scan_fill = s2c_ring_write_slot(&adc_scan_ring);
+		if(adc_scan_fill != NULL) {
+			alarm_unwatch();
+			adc_start_channel_job();
+		} else {
+			++adc_scan_overruns;
+		}
+	}
+	
+	// Take every completed scan, the newest one ends up in adc_channel_vals
+	struct adc_scan *scan;
+	while((scan = s2c_ring_read_slot(&adc_scan_ring)) != NULL) {
+		for(int i = 0; i < board_config.adc_channels; i++) {
+			adc_channel_vals[i] = scan->vals[i];
+		}
+		s2c_ring_release(&adc_scan_ring);
+		if(board_config.use_summary) summary_add_scan();
+		adc_section_done = true;
+	}
+}
+
+void loop_sampler(void) {
+	// Filter and analyse any block the sampler has filled since the last loop. Capture mode only needs the hook
+	uint16_t *block = sampler_get_block();
+	if(block != NULL) {
+		if(board_config.use_filter) filter_process(block);
+		if(board_config.use_analysis) analysis_process(block);
+		sampler_release_block();
+	}
+	
+	adc_channel_vals[0] = sampler_latest();
+	adc_section_done = true;
 }
 
 void loop_i2c(void) {
@@ -257,31 +408,45 @@ void loop_i2c(void) {
 }
 
 void loop_can(void) {
-	struct can_tx_element tx_elem;
-	can_get_tx_buffer_element_defaults(&tx_elem);
-	//tx_elem.T0.bit.XTD = 1;
+	uint16_t signal_vals[COV_MAX_SIGNALS];
+	uint8_t num_signals = 0;
+	const struct s2c_bitpack_signal *layout = NULL;
 	
+	// Collect frame 1's signals, in frame order
 	switch(board_type) {
 	case S2C_BOARD_WHEEL:
-		tx_elem.T1.bit.DLC = 4;
-		tx_elem.T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, 0));
-		convert_16_bit_to_byte_array(adc_channel_vals[0], tx_elem.data);
-		convert_16_bit_to_byte_array(i2c_temperature_vals[I2C_BRAKE_TEMP], tx_elem.data + 2);
+		signal_vals[0] = adc_channel_vals[0];
+		signal_vals[1] = i2c_temperature_vals[I2C_BRAKE_TEMP];
+		signal_vals[2] = 0;
+		if(board_config.pulse_mask & 0x1) {
+			// One divide per loop, however fast the wheel turns. The frame saturates it
+			uint32_t period_us = pulse_period_us(0);
+			uint32_t speed = (period_us > 0) ? WHEEL_SPEED_SCALE / period_us : 0;
+			signal_vals[2] = (speed > 0xFFFF) ? 0xFFFF : speed;
+		}
+		num_signals = 3;
+		layout = wheel_frame_layout;
+		
+		if(board_config.use_analysis) loop_can_analysis();
+		if(board_config.use_filter) loop_can_filter();
+		if(board_config.use_capture) loop_can_capture();
 		break;
 		
 	case S2C_BOARD_TIRE_TEMP:
-		tx_elem.T1.bit.DLC = 6;
-		tx_elem.T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, 0));
-		convert_16_bit_to_byte_array(i2c_temperature_vals[I2C_OUTER_TEMP], tx_elem.data);
-		convert_16_bit_to_byte_array(i2c_temperature_vals[I2C_MIDDLE_TEMP], tx_elem.data + 2);
-		convert_16_bit_to_byte_array(i2c_temperature_vals[I2C_INNER_TEMP], tx_elem.data + 4);
+		signal_vals[0] = i2c_temperature_vals[I2C_OUTER_TEMP];
+		signal_vals[1] = i2c_temperature_vals[I2C_MIDDLE_TEMP];
+		signal_vals[2] = i2c_temperature_vals[I2C_INNER_TEMP];
+		num_signals = 3;
+		layout = tire_temp_frame_layout;
 		break;
 		
 	case S2C_BOARD_RADIATOR:
-		tx_elem.T1.bit.DLC = 4;
-		tx_elem.T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, 0));
-		convert_16_bit_to_byte_array(adc_channel_vals[0], tx_elem.data);
-		convert_16_bit_to_byte_array(adc_channel_vals[1], tx_elem.data + 2);
+		// Sent in engineering units, offset so they stay unsigned
+		for(int i = 0; i < 2; i++) {
+			signal_vals[i] = radiator_signal(adc_channel_vals[i]);
+		}
+		num_signals = 2;
+		layout = radiator_frame_layout;
 		
 		/*//Dummy values
 		tx_elem.data[0] = 0x80 & 0xFF;
@@ -291,22 +456,305 @@ void loop_can(void) {
 		break;
 	}
 	
-	// only send if tx_element has been configured i.e. if ID has been set
-	if(tx_elem.T0.bit.ID > 0) {
-		can_set_tx_buffer_element(&can_instance, &tx_elem, 0);
-		can_tx_transfer_request(&can_instance, 1);
+	// Health goes first so it gets the shared debug buffer when due
+	can_health_update(loop_period_ms);
+	alarm_update(loop_period_ms);
+	loop_can_health();
+	loop_can_command();
+	if(board_config.pulse_mask) loop_can_pulse();
+	loop_can_trace();
+	loop_can_log();
+	if(USE_IRQ_REPORT) loop_can_irq_report();
+	if(USE_CAN_BENCH) loop_can_bench();
+	
+	// In summary mode frame 1 is only summarised, not sent
+	if(board_config.use_summary) {
+		loop_can_summary(num_signals);
+		return;
 	}
+	
+	// only send if this board has a frame 1 layout, if its TX buffer is free again
+	// and if a signal moved past its deadband or the heartbeat is due
+	if(layout == NULL) return;
+	struct can_tx_element *tx_elem = claim_tx_buffer(0);
+	if(tx_elem == NULL ||
+		!s2c_cov_update(&can_cov_state, signal_vals, board_config.cov_deadband, num_signals, loop_period_ms, board_config.cov_heartbeat_ms)) {
+		return;
+	}
+	
+	// Encode frame 1, either bit-packed to each signal's exact width or as 16-bit words
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, 0));
+#if CAN_BITPACK_FRAMES
+	tx_elem->T1.bit.DLC = s2c_bitpack_encode(tx_elem->data, layout, signal_vals, num_signals);
+#else
+	for(int i = 0; i < num_signals; i++) {
+		convert_16_bit_to_byte_array(signal_vals[i], tx_elem->data + 2 * i);
+	}
+	tx_elem->T1.bit.DLC = 2 * num_signals;
+#endif
+	send_tx_buffer(tx_elem, 0);
+}
+
+void loop_can_analysis(void) {
+	uint16_t bands[ANALYSIS_NUM_BANDS];
+	
+	// Band energies only change once per sampler block, so only send them then
+	if(!analysis_get_bands(bands)) return;
+	
+	struct can_tx_element *tx_elem = claim_tx_buffer(1);
+	if(tx_elem == NULL) return;
+	tx_elem->T1.bit.DLC = 2 * ANALYSIS_NUM_BANDS;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, 1));
+	for(int i = 0; i < ANALYSIS_NUM_BANDS; i++) {
+		convert_16_bit_to_byte_array(bands[i], tx_elem->data + 2 * i);
+	}
+	send_tx_buffer(tx_elem, 1);
+}
+
+void loop_can_filter(void) {
+	// One payload per loop on frame 2's TX buffer, which the bands only need once per block
+	struct can_tx_element *tx_elem = claim_tx_buffer(1);
+	if(tx_elem == NULL) return;
+	uint8_t length = filter_drain(tx_elem->data);
+	if(length == 0) return;
+	
+	tx_elem->T1.bit.DLC = length;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_FILTER));
+	send_tx_buffer(tx_elem, 1);
+}
+
+void loop_can_capture(void) {
+	// Drain on the spare TX buffers, skipping any that are still waiting for the bus
+	for(int i = 0; i < CAPTURE_FRAMES_PER_LOOP; i++) {
+		uint32_t buffer_index = 2 + i;
+		struct can_tx_element *tx_elem = claim_tx_buffer(buffer_index);
+		if(tx_elem == NULL) continue;
+		if(!capture_drain(tx_elem->data)) return;
+		
+		tx_elem->T1.bit.DLC = 8;
+		tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_CAPTURE));
+		send_tx_buffer(tx_elem, buffer_index);
+	}
+}
+
+/*
+ * Adds the scan loop_adc() just took to the summary window, in frame 1's units,
+ * so every scan counts however many of them one loop takes
+ */
+void summary_add_scan(void) {
+	// Only the radiator board has summary mode
+	for(int i = 0; i < 2; i++) {
+		s2c_stats_add(&summary_stats[i], radiator_signal(adc_channel_vals[i]));
+	}
+}
+
+void loop_can_summary(uint8_t num_signals) {
+	// Close the window: latch the results and start a new one
+	summary_elapsed_ms += loop_period_ms;
+	if(summary_elapsed_ms >= SUMMARY_WINDOW_MS) {
+		for(int i = 0; i < num_signals; i++) {
+			s2c_stats_get(&summary_stats[i], &summary_results[i]);
+			s2c_stats_reset(&summary_stats[i]);
+		}
+		summary_elapsed_ms = 0;
+		summary_pending = num_signals;
+	}
+	
+	// Send one latched summary per loop on frame 1's TX buffer
+	struct can_tx_element *tx_elem = (summary_pending > 0) ? claim_tx_buffer(0) : NULL;
+	if(tx_elem != NULL) {
+		uint8_t i = num_signals - summary_pending;
+		tx_elem->T1.bit.DLC = 8;
+		tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_SUMMARY + i));
+		convert_16_bit_to_byte_array(summary_results[i].min, tx_elem->data);
+		convert_16_bit_to_byte_array(summary_results[i].max, tx_elem->data + 2);
+		convert_16_bit_to_byte_array(summary_results[i].mean, tx_elem->data + 4);
+		convert_16_bit_to_byte_array(summary_results[i].rms, tx_elem->data + 6);
+		send_tx_buffer(tx_elem, 0);
+		--summary_pending;
+	}
+}
+
+void loop_can_trace(void) {
+	// Dump the previous run's trace on the debug TX buffer, one packet per loop
+	struct can_tx_element *tx_elem = claim_tx_buffer(CAN_TX_BUFFER_DEBUG);
+	bool header;
+	if(tx_elem == NULL || !trace_drain(tx_elem->data, &header)) return;
+	
+	tx_elem->T1.bit.DLC = 8;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, header ? CAN_MSG_TRACE_HEADER : CAN_MSG_TRACE));
+	send_tx_buffer(tx_elem, CAN_TX_BUFFER_DEBUG);
+}
+
+void loop_can_health(void) {
+	struct can_tx_element *tx_elem = can_health_report_due() ? claim_tx_buffer(CAN_TX_BUFFER_DEBUG) : NULL;
+	if(tx_elem == NULL) return;
+	
+	tx_elem->T1.bit.DLC = 8;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_HEALTH));
+	can_health_report(tx_elem->data);
+	send_tx_buffer(tx_elem, CAN_TX_BUFFER_DEBUG);
+}
+
+void loop_can_command(void) {
+	static uint8_t reply[8];
+	static bool reply_pending = false;
+	
+	// Take a new command only once the last reply is out, so none are lost to a busy buffer
+	if(!reply_pending && (can_rx_get_fifo_status(&can_instance, 0) & CAN_RXF0S_F0FL_Msk)) {
+		struct can_rx_element_fifo_0 rx_elem;
+		uint32_t get_index = (can_rx_get_fifo_status(&can_instance, 0) & CAN_RXF0S_F0GI_Msk) >> CAN_RXF0S_F0GI_Pos;
+		can_get_rx_fifo_0_element(&can_instance, &rx_elem, get_index);
+		can_rx_fifo_acknowledge(&can_instance, 0, get_index);
+		
+		memset(reply, 0, sizeof(reply));
+		if(rx_elem.R1.bit.DLC >= 4) {
+			nvm_command(rx_elem.data, reply);
+		} else {
+			reply[4] = NVM_STATUS_BAD_COMMAND;
+		}
+		reply_pending = true;
+	}
+	
+	struct can_tx_element *tx_elem = reply_pending ? claim_tx_buffer(CAN_TX_BUFFER_DEBUG) : NULL;
+	if(tx_elem == NULL) return;
+	
+	tx_elem->T1.bit.DLC = 5;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_COMMAND_REPLY));
+	memcpy(tx_elem->data, reply, 5);
+	send_tx_buffer(tx_elem, CAN_TX_BUFFER_DEBUG);
+	reply_pending = false;
+}
+
+void loop_can_pulse(void) {
+	static uint16_t pulse_elapsed_ms = 0;
+	pulse_elapsed_ms += loop_period_ms;
+	if(pulse_elapsed_ms < PULSE_FRAME_PERIOD_MS) return;
+	
+	struct can_tx_element *tx_elem = claim_tx_buffer(CAN_TX_BUFFER_PULSE);
+	if(tx_elem == NULL) return;
+	pulse_elapsed_ms = 0;
+	
+	for(uint8_t i = 0; i < PULSE_NUM_INPUTS; i++) {
+		uint32_t frequency = pulse_frequency(i);
+		convert_16_bit_to_byte_array((frequency > 0xFFFF) ? 0xFFFF : frequency, tx_elem->data + 2 * i);
+	}
+	tx_elem->T1.bit.DLC = 2 * PULSE_NUM_INPUTS;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_PULSE));
+	send_tx_buffer(tx_elem, CAN_TX_BUFFER_PULSE);
+}
+
+/**
+ * \brief Alarm hook, sends the alarm frame straight from the ADC interrupt
+ *
+ * Only the alarm uses its buffer, so the frame is written into its element in
+ * message RAM directly instead of through claim_tx_buffer(), whose staging
+ * element and error passive allowance belong to the main loop. The alarm is
+ * the one frame the passive gate lets through; bus-off still holds it back.
+ *
+ * \return true if the frame was queued, false if the last alarm frame is still
+ * waiting for the bus or the module is bus-off
+ *
+ */
+RAMFUNC bool alarm_send(uint8_t channel, bool tripped, uint16_t value) {
+	if(can_instance.hw->CCCR.reg & CAN_CCCR_INIT) return false;
+	if(can_instance.hw->TXBRP.reg & (1UL << CAN_TX_BUFFER_ALARM)) return false;
+	
+	struct can_tx_element *tx_elem = can_alarm_elem;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_ALARM_ID(board_id));
+	tx_elem->T1.reg = CAN_TX_ELEMENT_T1_DLC(4);
+	tx_elem->data[0] = channel;
+	tx_elem->data[1] = tripped;
+	convert_16_bit_to_byte_array(value, tx_elem->data + 2);
+	can_instance.hw->TXBAR.reg = 1UL << CAN_TX_BUFFER_ALARM;
+	return true;
+}
+
+void loop_can_log(void) {
+	// Drain one log record per loop on the debug TX buffer
+	struct can_tx_element *tx_elem = claim_tx_buffer(CAN_TX_BUFFER_DEBUG);
+	if(tx_elem == NULL || !log_drain(tx_elem->data)) return;
+	
+	tx_elem->T1.bit.DLC = 8;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_LOG));
+	send_tx_buffer(tx_elem, CAN_TX_BUFFER_DEBUG);
+}
+
+void loop_can_bench(void) {
+	can_bench_update(loop_period_ms);
+	struct can_tx_element *tx_elem = claim_tx_buffer(CAN_TX_BUFFER_DEBUG);
+	if(tx_elem == NULL || !can_bench_report(tx_elem->data)) return;
+	
+	tx_elem->T1.bit.DLC = 8;
+	tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_BENCH));
+	send_tx_buffer(tx_elem, CAN_TX_BUFFER_DEBUG);
+}
+
+void loop_can_irq_report(void) {
+	irq_report_elapsed_ms += loop_period_ms;
+	if(irq_report_elapsed_ms >= IRQ_REPORT_PERIOD_MS) {
+		irq_report_elapsed_ms = 0;
+		irq_report_pending = IRQ_NUM_SOURCES;
+	}
+	
+	// One source per loop on the debug TX buffer
+	struct can_tx_element *tx_elem = (irq_report_pending > 0) ? claim_tx_buffer(CAN_TX_BUFFER_DEBUG) : NULL;
+	if(tx_elem != NULL) {
+		tx_elem->T1.bit.DLC = 8;
+		tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(CAN_MSG_ID(board_id, CAN_MSG_DEBUG));
+		irq_report(IRQ_NUM_SOURCES - irq_report_pending, tx_elem->data);
+		send_tx_buffer(tx_elem, CAN_TX_BUFFER_DEBUG);
+		--irq_report_pending;
+	}
+}
+
+/*
+ * Returns the element to build a frame for TX buffer index in, with default T0/T1,
+ * or NULL if that buffer is still waiting for the bus or the CAN health manager
+ * is holding it back.
+ * With CAN_ZERO_COPY_TX this is the buffer's element in CAN message RAM itself,
+ * so the payload is encoded straight into it and nothing is copied on send.
+ */
+struct can_tx_element *claim_tx_buffer(uint32_t index) {
+	if(can_tx_get_pending_status(&can_instance) & (1UL << index)) return NULL;
+	if(!can_health_tx_allowed(index)) return NULL;
+	
+#if CAN_ZERO_COPY_TX
+	struct can_tx_element *tx_elem = can_get_tx_buffer_element_address(&can_instance, index);
+#else
+	struct can_tx_element *tx_elem = &can_tx_staging;
+#endif
+	can_get_tx_buffer_element_defaults(tx_elem);
+#if CONF_CAN_FD_ENABLE
+	// FD frames with the data phase at the data bitrate
+	tx_elem->T1.reg |= CAN_TX_ELEMENT_T1_FDF | CAN_TX_ELEMENT_T1_BRS;
+#endif
+	return tx_elem;
+}
+
+/*
+ * Requests transmission of a frame built in claim_tx_buffer()'s element
+ */
+void send_tx_buffer(struct can_tx_element *tx_elem, uint32_t index) {
+#if !CAN_ZERO_COPY_TX
+	can_set_tx_buffer_element(&can_instance, tx_elem, index);
+#endif
+	can_tx_transfer_request(&can_instance, 1UL << index);
 }
 
 
 int main (void)
 {
 	system_init();
+	trace_init(); // before anything can overwrite the previous run's trace
+	log_init();
+	nvm_init();
 
-	// If code is configured to use pinstraps, do so. If not, leave at default
-	board_id = get_pinstrap_id();
+	// The NVM record's ID wins over the pinstraps
+	board_id = (nvm_get(NVM_FIELD_BOARD_ID) != NVM_UNSET) ? nvm_get(NVM_FIELD_BOARD_ID) : get_pinstrap_id();
 
 	board_type = get_board_type_from_id(board_id);
+	S2C_LOG("boot: board %u, type %u, reset cause 0x%02x", board_id, board_type, system_get_reset_cause());
 	
 	switch(board_type) {
 	case S2C_BOARD_WHEEL:
@@ -323,20 +771,65 @@ int main (void)
 	
 	//default: do anything?
 	}
+	// Overrides from the NVM record
+	if(nvm_get(NVM_FIELD_COV_HEARTBEAT_MS) != NVM_UNSET) board_config.cov_heartbeat_ms = nvm_get(NVM_FIELD_COV_HEARTBEAT_MS);
+	for(int i = 0; i < COV_MAX_SIGNALS; i++) {
+		if(nvm_get(NVM_FIELD_COV_DEADBAND + i) != NVM_UNSET) board_config.cov_deadband[i] = nvm_get(NVM_FIELD_COV_DEADBAND + i);
+	}
+	if(nvm_get(NVM_FIELD_LOOP_PERIOD_MS) != NVM_UNSET) loop_period_ms = nvm_get(NVM_FIELD_LOOP_PERIOD_MS);
+	// Before any peripheral reads its clock
+	clock_set_profile(board_config.clock_profile);
+	
 	// Confirm that there is no violation that could lead to the adc channel index being greater than the sample array
 	Assert(board_config.adc_channels <= ADC_NUM_CHANNELS);
 	
 	// Configure ADC and I2C depending on board configuration
 	if(board_config.use_adc) {
+		s2c_ring_init(&adc_scan_ring, adc_scans, sizeof(adc_scans[0]), ADC_SCAN_RING_SLOTS);
 		configure_adc();
 	}
+	if(board_config.use_filter) {
+		filter_init();
+	}
+	if(board_config.use_analysis) {
+		analysis_init();
+	}
+	if(board_config.use_capture) {
+		capture_init(&adc_instance);
+		sampler_set_hook(capture_sample);
+	}
+	if(board_config.use_adc && board_config.alarm_channel >= 0) {
+		// Not with the sampler, it never leaves the ADC idle
+		Assert(!board_config.use_filter && !board_config.use_analysis && !board_config.use_capture);
+		alarm_init(&adc_instance, board_config.alarm_channel, adc_channel[board_config.alarm_channel],
+			board_config.alarm_below, board_config.alarm_threshold, alarm_send);
+	}
+	if(board_config.use_filter || board_config.use_analysis || board_config.use_capture) {
+		// Analysis needs its exact rate for 1 Hz bins and the filter's cutoffs are set for it too,
+		// capture runs faster when it has the sampler to itself
+		bool fixed_rate = board_config.use_filter || board_config.use_analysis;
+		sampler_init(&adc_instance, adc_channel[0], fixed_rate ? SAMPLER_RATE_HZ : CAPTURE_RATE_HZ);
+	}
 	if(board_config.use_i2c) {
 		configure_i2c();
 	}
+	// Pulse inputs 0 and 1 share the AN1 and AN2 pads with ADC channels 1 and 2
+	Assert(!(board_config.pulse_mask & 0x1) || board_config.adc_channels < 2);
+	Assert(!(board_config.pulse_mask & 0x2) || board_config.adc_channels < 3);
+	pulse_init(board_config.pulse_mask);
 	configure_can(); // this is always configured. any use cases where it shouldn't be?
+	irq_init(); // after sampler_init(), which resets the SysTick priority
+	
+	s2c_rate_init(&rate_state);
+	for(int i = 0; i < COV_MAX_SIGNALS; i++) {
+		s2c_stats_reset(&summary_stats[i]);
+	}
 	
 	system_interrupt_enable_global();
 	
+	// Needs the CAN interrupt, and nothing else queued on CAN yet
+	if(USE_CAN_BENCH) can_bench_run(&can_instance, claim_tx_buffer, send_tx_buffer);
+	
 	// Turn on generic LED to indicate that config is done
 	port_pin_set_output_level(LED_USER_PIN, true);
 	
@@ -352,7 +845,12 @@ int main (void)
 		if((!board_config.use_adc || adc_section_done) && 
 			(!board_config.use_i2c || i2c_section_done)) {
 			loop_can();
-			delay_ms(20);
+			
+			// Speed the loop up while the suspension is busy, slow it down when it's quiet
+			if(board_config.use_adaptive_rate) {
+				loop_period_ms = s2c_rate_update(&rate_state, adc_channel_vals[0]);
+			}
+			delay_ms(loop_period_ms);
 			adc_section_done = i2c_section_done = false;
 		}
 	}
@@ -360,11 +858,19 @@ int main (void)
 
 void CAN0_Handler(void)
 {
+	uint32_t entry = irq_enter();
 	volatile uint32_t status;
 	status = can_read_interrupt_status(&can_instance);
 	
 	if ((status & CAN_PROTOCOL_ERROR_ARBITRATION) || (status & CAN_PROTOCOL_ERROR_DATA)) {
 		can_clear_interrupt_status(&can_instance, CAN_PROTOCOL_ERROR_ARBITRATION | CAN_PROTOCOL_ERROR_DATA);
-		//printf("Protocol error, please double check the clock in two boards. \r\n\r\n");
+		// Counted into the health frame. Persistent errors usually mean mismatched clocks between boards
+		can_health_protocol_error(can_read_protocal_status(&can_instance));
+	}
+	// Only enabled while the benchmark runs
+	if(USE_CAN_BENCH && (status & CAN_RX_FIFO_0_NEW_MESSAGE)) {
+		can_clear_interrupt_status(&can_instance, CAN_RX_FIFO_0_NEW_MESSAGE);
+		can_bench_rx(entry);
 	}
+	irq_exit(IRQ_SOURCE_CAN, entry);
 }
\ No newline at end of file
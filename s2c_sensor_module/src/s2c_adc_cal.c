@@ -0,0 +1,96 @@
+/*
+ * s2c_adc_cal.c
+ *
+ * Created: 2026-10-19 10:58:12 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_adc_cal.h>
+#include <s2c_log.h>
+
+#define ADC_CAL_GAIN_ONE	2048 // GAINCORR is 1.11 fixed point
+
+/**
+ * \brief Averages ADC_CAL_SAMPLES polled conversions of one input
+ *
+ * \return sum of the results, in 1/ADC_CAL_SAMPLES LSB
+ *
+ */
+static int32_t adc_cal_measure(struct adc_module *module, struct adc_config *config) {
+	adc_init(module, module->hw, config);
+	adc_enable(module);
+
+	int32_t sum = 0;
+	for(int i = -1; i < ADC_CAL_SAMPLES; i++) {
+		uint16_t result;
+		adc_start_conversion(module);
+		while(adc_read(module, &result) == STATUS_BUSY);
+		// The first conversion after a mux change is thrown away
+		if(i >= 0) sum += result;
+	}
+
+	adc_disable(module);
+	return sum;
+}
+
+/**
+ * \brief Measures the ADC's gain and offset error
+ *
+ * Leaves the ADC disabled, so call before the application's adc_init().
+ *
+ * \param module		ADC instance, already initialised once
+ * \param config		settings the application runs the ADC with
+ * \param correction	filled with the correction register values
+ *
+ * \return true if the measured errors are plausible and correction was filled
+ *
+ */
+bool adc_cal_run(struct adc_module *module, const struct adc_config *config, struct adc_correction_config *correction) {
+	struct adc_config cal = *config;
+	cal.correction.correction_enable = false;
+	int32_t full_scale = (cal.resolution == ADC_RESOLUTION_12BIT) ? 4096 : (cal.resolution == ADC_RESOLUTION_10BIT) ? 1024 : 256;
+
+	// Single-ended like the application, since that's the offset OFFSETCORR takes off
+	cal.differential_mode = false;
+	cal.negative_input = ADC_NEGATIVE_INPUT_GND;
+
+	struct port_config zero_pin;
+	port_get_config_defaults(&zero_pin);
+	zero_pin.direction = PORT_PIN_DIR_OUTPUT;
+	port_pin_set_config(ADC_CAL_ZERO_GPIO, &zero_pin);
+	port_pin_set_output_level(ADC_CAL_ZERO_GPIO, false);
+	cal.positive_input = ADC_CAL_ZERO_PIN;
+	int32_t offset = adc_cal_measure(module, &cal);
+	// Back to its reset state, unconnected
+	struct system_pinmux_config zero_pin_off;
+	system_pinmux_get_config_defaults(&zero_pin_off);
+	zero_pin_off.powersave = true;
+	system_pinmux_pin_set_config(ADC_CAL_ZERO_GPIO, &zero_pin_off);
+
+	cal.positive_input = ADC_POSITIVE_INPUT_SCALEDIOVCC;
+	int32_t quarter = adc_cal_measure(module, &cal) - offset;
+
+	// The bandgap only reaches the ADC with its output enabled
+	uint32_t vref = SUPC->VREF.reg;
+	SUPC->VREF.reg = vref | SUPC_VREF_VREFOE | SUPC_VREF_ONDEMAND;
+	cal.positive_input = ADC_POSITIVE_INPUT_BANDGAP;
+	int32_t bandgap = adc_cal_measure(module, &cal) - offset;
+	SUPC->VREF.reg = vref;
+
+	// All three are in 1/ADC_CAL_SAMPLES LSB
+	int32_t expected = full_scale / 4 * ADC_CAL_SAMPLES;
+	uint16_t vddana_mv = (bandgap > 0) ? (uint32_t)ADC_CAL_VREF_MV * full_scale * ADC_CAL_SAMPLES / bandgap : 0;
+	int32_t offset_lsb = (offset + (offset >= 0 ? ADC_CAL_SAMPLES / 2 : -ADC_CAL_SAMPLES / 2)) / ADC_CAL_SAMPLES;
+	S2C_LOG("adc cal: offset %d/64, quarter scale %u/64, vddana %u mV", (int16_t)offset, (uint16_t)quarter, vddana_mv);
+
+	if(quarter <= 0 || offset_lsb > ADC_CAL_MAX_OFFSET || offset_lsb < -ADC_CAL_MAX_OFFSET) return false;
+	int32_t gain = (expected * ADC_CAL_GAIN_ONE + quarter / 2) / quarter;
+	if(gain > ADC_CAL_GAIN_ONE * (1000 + ADC_CAL_MAX_GAIN_ERROR_PERMILLE) / 1000 ||
+			gain < ADC_CAL_GAIN_ONE * (1000 - ADC_CAL_MAX_GAIN_ERROR_PERMILLE) / 1000) return false;
+
+	// The hardware subtracts the offset, then scales by the gain
+	correction->correction_enable = true;
+	correction->gain_correction = gain;
+	correction->offset_correction = offset_lsb;
+	return true;
+}
@@ -0,0 +1,47 @@
+/*
+ * s2c_adc_cal.h
+ *
+ * Created: 2026-10-19 10:58:12 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_ADC_CAL_H_
+#define S2C_ADC_CAL_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * ADC gain and offset self-calibration.
+ *
+ * Works out the values for the ADC's own correction registers, which then
+ * correct every result in hardware, with no CPU work per sample. Measured with
+ * the application's ADC settings, from signals inside the chip:
+ * - offset: a single-ended conversion, like the application's, of
+ *   ADC_CAL_ZERO_PIN while it is driven low, so whatever it reads is the
+ *   offset. Single-ended results can't go below 0, so a negative offset reads
+ *   as 0 and is left uncorrected
+ * - gain: VDDIO / 4 against the VDDANA reference. The module runs both off
+ *   the same 3.3 V rail, so this has to read a quarter of full scale
+ * - the bandgap reference (SUPC VREF, 1.024 V, its output to the ADC enabled
+ *   for the measurement) against VDDANA gives the supply voltage, logged to
+ *   spot a bad rail rather than a bad ADC
+ * A result that is further off than ADC_CAL_MAX_GAIN_ERROR_PERMILLE or
+ * ADC_CAL_MAX_OFFSET isn't a plausible ADC error, and is thrown away.
+ *
+ * main.c runs this at boot when the NVM record (s2c_nvm.h) has no
+ * calibration yet and saves the result there. Unset NVM_FIELD_ADC_GAIN_CORR
+ * over the command channel and reset to calibrate again.
+ */
+
+#define ADC_CAL_SAMPLES						64 // conversions averaged per measurement
+#define ADC_CAL_ZERO_PIN					ADC_POSITIVE_INPUT_PIN6 // an ADC pin the board leaves unconnected
+#define ADC_CAL_ZERO_GPIO					PIN_PA06 // the same pin, driven low while measured
+#define ADC_CAL_VREF_MV						1024
+#define ADC_CAL_MAX_GAIN_ERROR_PERMILLE		50
+#define ADC_CAL_MAX_OFFSET					32 // result LSB
+
+bool adc_cal_run(struct adc_module *module, const struct adc_config *config, struct adc_correction_config *correction);
+
+#endif /* S2C_ADC_CAL_H_ */
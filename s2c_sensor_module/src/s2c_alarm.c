@@ -0,0 +1,138 @@
+/*
+ * s2c_alarm.c
+ *
+ * Created: 2026-10-20 12:18:40 AM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_alarm.h>
+
+enum alarm_state {
+	ALARM_ARMED,		// watching, nothing to report
+	ALARM_HOLDOFF,		// tripped, window interrupt off
+	ALARM_CLEARING		// watching again after a trip, clears if nothing trips
+};
+
+static struct adc_module *alarm_module = NULL;
+static uint8_t alarm_channel;
+static uint32_t alarm_input;
+static alarm_hook_t alarm_hook = NULL;
+static volatile enum alarm_state alarm_state = ALARM_ARMED;
+static volatile bool alarm_watching = false; // the ADC is free-running for the alarm
+static volatile bool alarm_trip_unsent = false; // the hook couldn't queue the last trip's frame
+static volatile uint16_t alarm_trip_value;
+static uint16_t alarm_elapsed_ms = 0;
+
+RAMFUNC static void alarm_set_freerun(bool freerun) {
+	Adc *adc = alarm_module->hw;
+	while(adc_is_syncing(alarm_module));
+	adc->CTRLC.reg = freerun ? (adc->CTRLC.reg | ADC_CTRLC_FREERUN) : (adc->CTRLC.reg & ~ADC_CTRLC_FREERUN);
+	while(adc_is_syncing(alarm_module));
+}
+
+RAMFUNC static void alarm_window_callback(struct adc_module *const module) {
+	// Off until alarm_update() re-arms it, or every conversion would land here
+	adc_disable_interrupt(module, ADC_INTERRUPT_WINDOW);
+	alarm_state = ALARM_HOLDOFF;
+	alarm_elapsed_ms = 0;
+	alarm_trip_value = module->hw->RESULT.reg;
+	alarm_trip_unsent = !alarm_hook(alarm_channel, true, alarm_trip_value);
+}
+
+/**
+ * \brief Sets the alarm up, call after adc_init()
+ *
+ * \param module	ADC instance
+ * \param channel	ADC channel index, for the frame
+ * \param adc_input	positive input of that channel
+ * \param below		true to trip below threshold, false above it
+ * \param threshold	ADC result, after the gain/offset correction
+ * \param hook		sends the alarm frame
+ *
+ */
+void alarm_init(struct adc_module *const module, uint8_t channel, uint32_t adc_input, bool below, uint16_t threshold, alarm_hook_t hook) {
+	alarm_module = module;
+	alarm_channel = channel;
+	alarm_input = adc_input;
+	alarm_hook = hook;
+
+	// Only results while watching matter, the scans' results match too but the interrupt is off then
+	if(below) {
+		adc_set_window_mode(module, ADC_WINDOW_MODE_BELOW_UPPER, 0, threshold);
+	} else {
+		adc_set_window_mode(module, ADC_WINDOW_MODE_ABOVE_LOWER, threshold, 0);
+	}
+	adc_register_callback(module, alarm_window_callback, ADC_CALLBACK_WINDOW);
+	adc_enable_callback(module, ADC_CALLBACK_WINDOW);
+	adc_disable_interrupt(module, ADC_INTERRUPT_WINDOW); // until the first alarm_watch()
+}
+
+/**
+ * \brief Hands the idle ADC to the alarm, call when a scan has finished
+ *
+ * Runs in the ADC interrupt.
+ *
+ */
+RAMFUNC void alarm_watch(void) {
+	if(alarm_module == NULL) return;
+
+	adc_set_positive_input(alarm_module, alarm_input);
+	alarm_module->hw->INTFLAG.reg = ADC_INTFLAG_WINMON;
+	if(alarm_state != ALARM_HOLDOFF) {
+		adc_enable_interrupt(alarm_module, ADC_INTERRUPT_WINDOW);
+	}
+	alarm_set_freerun(true);
+	adc_start_conversion(alarm_module);
+	alarm_watching = true;
+}
+
+/**
+ * \brief Takes the ADC back for a scan
+ *
+ * Stops the free-running conversions and throws away their last result, so
+ * the scan's buffer job doesn't pick it up. Does nothing while a scan runs.
+ *
+ */
+void alarm_unwatch(void) {
+	if(!alarm_watching) return;
+	alarm_watching = false;
+
+	adc_disable_interrupt(alarm_module, ADC_INTERRUPT_WINDOW);
+	alarm_set_freerun(false);
+	adc_flush(alarm_module);
+	alarm_module->hw->INTFLAG.reg = ADC_INTFLAG_RESRDY | ADC_INTFLAG_WINMON | ADC_INTFLAG_OVERRUN;
+}
+
+/**
+ * \brief Runs the holdoff and clears the alarm, call once per main loop
+ *
+ * Also retries the trip or clear frame the hook couldn't queue last time.
+ *
+ * \param elapsed_ms	time since the last call
+ *
+ */
+void alarm_update(uint16_t elapsed_ms) {
+	if(alarm_module == NULL || alarm_state == ALARM_ARMED) return;
+
+	if(alarm_elapsed_ms < ALARM_HOLDOFF_MS) alarm_elapsed_ms += elapsed_ms;
+	if(alarm_elapsed_ms < ALARM_HOLDOFF_MS && !alarm_trip_unsent) return;
+
+	// Everything here races the window interrupt, which may trip again right now
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(alarm_trip_unsent) {
+		if(alarm_hook(alarm_channel, true, alarm_trip_value)) {
+			alarm_trip_unsent = false;
+			alarm_elapsed_ms = 0; // the holdoff counts from the trip that got out
+		}
+	} else if(alarm_elapsed_ms >= ALARM_HOLDOFF_MS) {
+		if(alarm_state == ALARM_HOLDOFF) {
+			alarm_elapsed_ms = 0;
+			alarm_state = ALARM_CLEARING; // re-armed by the next alarm_watch()
+		} else if(alarm_hook(alarm_channel, false, 0)) {
+			alarm_elapsed_ms = 0;
+			alarm_state = ALARM_ARMED;
+		} // else still clearing, tried again next loop
+	}
+	__set_PRIMASK(primask);
+}
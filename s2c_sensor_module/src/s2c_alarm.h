@@ -0,0 +1,49 @@
+/*
+ * s2c_alarm.h
+ *
+ * Created: 2026-10-20 12:18:40 AM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_ALARM_H_
+#define S2C_ALARM_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Hardware threshold alarm on one ADC channel.
+ *
+ * The ADC is idle between the main loop's scans, so in between it free-runs
+ * on the alarm channel with the window monitor watching the results. The
+ * first result past the threshold raises the window interrupt a conversion
+ * time (a few us) after the crossing, and the hook sends the alarm frame
+ * right there, whatever the loop period. No other interrupt fires while
+ * watching, the results themselves are never read.
+ *
+ * After a trip the window interrupt stays off for ALARM_HOLDOFF_MS, so a
+ * signal that stays past the threshold repeats the alarm at that rate
+ * instead of on every conversion. One whole holdoff without a trip clears it.
+ * A frame the hook couldn't queue (its buffer still busy, bus-off) is retried
+ * by alarm_update() every loop, and the alarm stays where it was until it goes
+ * out, so neither a trip nor its clear is lost.
+ *
+ * Frame CAN_ALARM_ID(id), an ID below every telemetry frame so it wins
+ * arbitration: 4 bytes
+ * --> byte 0: ADC channel
+ * --> byte 1: 1 tripped, 0 cleared
+ * --> bytes 2 & 3: ADC result that tripped it, 0 when cleared
+ */
+
+#define ALARM_HOLDOFF_MS	100
+
+// Called from the ADC interrupt on a trip, and from alarm_update() to clear or retry, true once the frame is queued
+typedef bool (*alarm_hook_t)(uint8_t channel, bool tripped, uint16_t value);
+
+void alarm_init(struct adc_module *const module, uint8_t channel, uint32_t adc_input, bool below, uint16_t threshold, alarm_hook_t hook);
+void alarm_watch(void);
+void alarm_unwatch(void);
+void alarm_update(uint16_t elapsed_ms);
+
+#endif /* S2C_ALARM_H_ */
@@ -0,0 +1,94 @@
+/*
+ * s2c_analysis.c
+ *
+ * Created: 2026-10-19 10:41:52 AM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_analysis.h>
+
+// Shift between 10-bit ADC counts and q15, same as the filtering stage
+#define ANALYSIS_Q15_SHIFT		5
+
+// Converts a frequency into an FFT bin index
+#define ANALYSIS_HZ_TO_BIN(hz)	((hz) * SAMPLER_BLOCK_SIZE / SAMPLER_RATE_HZ)
+
+static const uint16_t band_edges_hz[ANALYSIS_NUM_BANDS + 1] = ANALYSIS_BAND_EDGES_HZ;
+
+static arm_rfft_instance_q15 rfft_instance;
+
+static q15_t analysis_window[SAMPLER_BLOCK_SIZE];
+static q15_t analysis_in[SAMPLER_BLOCK_SIZE];
+static q15_t analysis_spectrum[2 * SAMPLER_BLOCK_SIZE]; // arm_rfft_q15 writes the full complex spectrum
+static q15_t analysis_power[SAMPLER_BLOCK_SIZE / 2];
+
+static uint16_t band_energy[ANALYSIS_NUM_BANDS] = {0};
+static bool bands_updated = false;
+
+/**
+ * \brief Sets up the real FFT and precomputes the Hann window
+ */
+void analysis_init(void) {
+	arm_status status = arm_rfft_init_q15(&rfft_instance, SAMPLER_BLOCK_SIZE, 0, 1);
+	Assert(status == ARM_MATH_SUCCESS);
+	UNUSED(status);
+
+	// w[n] = 0.5 - 0.5 * cos(2 * pi * n / N). arm_cos_q15 takes the angle as a fraction of 2 * pi
+	for(int i = 0; i < SAMPLER_BLOCK_SIZE; i++) {
+		q15_t c = arm_cos_q15((q15_t)(i * (32768 / SAMPLER_BLOCK_SIZE)));
+		// At n = N / 2 the cosine is -32768 and the peak is 32768, one past q15. Clip it
+		int32_t w = 16384 - (c >> 1);
+		analysis_window[i] = (w > 32767) ? 32767 : (q15_t)w;
+	}
+}
+
+/**
+ * \brief Computes the band energies of one block of raw ADC samples
+ *
+ * Runs in the main loop. Takes a few ms for a 256-point block at 16 MHz.
+ *
+ */
+void analysis_process(const uint16_t *block) {
+	// Remove the DC level (static ride height) so it doesn't leak into the body band
+	uint32_t sum = 0;
+	for(int i = 0; i < SAMPLER_BLOCK_SIZE; i++) {
+		sum += block[i];
+	}
+	int16_t mean = sum / SAMPLER_BLOCK_SIZE;
+
+	for(int i = 0; i < SAMPLER_BLOCK_SIZE; i++) {
+		analysis_in[i] = (q15_t)((block[i] - mean) * (1 << ANALYSIS_Q15_SHIFT));
+	}
+	arm_mult_q15(analysis_in, analysis_window, analysis_in, SAMPLER_BLOCK_SIZE);
+
+	arm_rfft_q15(&rfft_instance, analysis_in, analysis_spectrum);
+	arm_cmplx_mag_squared_q15(analysis_spectrum, analysis_power, SAMPLER_BLOCK_SIZE / 2);
+
+	for(int band = 0; band < ANALYSIS_NUM_BANDS; band++) {
+		uint32_t energy = 0;
+		for(int bin = ANALYSIS_HZ_TO_BIN(band_edges_hz[band]); bin < ANALYSIS_HZ_TO_BIN(band_edges_hz[band + 1]); bin++) {
+			energy += analysis_power[bin];
+		}
+		band_energy[band] = (energy > 0xFFFF) ? 0xFFFF : energy;
+	}
+	bands_updated = true;
+}
+
+/**
+ * \brief Gets the band energies if a new block has been analysed since the last call
+ *
+ * \param bands array of ANALYSIS_NUM_BANDS values
+ *
+ * \return true if bands was filled
+ *
+ */
+bool analysis_get_bands(uint16_t *bands) {
+	if(!bands_updated) {
+		return false;
+	}
+	for(int i = 0; i < ANALYSIS_NUM_BANDS; i++) {
+		bands[i] = band_energy[i];
+	}
+	bands_updated = false;
+	return true;
+}
@@ -0,0 +1,29 @@
+/*
+ * s2c_analysis.h
+ *
+ * Created: 2026-10-19 10:41:52 AM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_ANALYSIS_H_
+#define S2C_ANALYSIS_H_
+
+#include <asf.h>
+#include <arm_math.h>
+#include <s2c_utils.h>
+
+/*
+ * Band energy analysis of the suspension signal.
+ *
+ * Each SAMPLER_BLOCK_SIZE block from the sampler is Hann windowed, run through a
+ * q15 real FFT (arm_rfft_q15) and the squared magnitudes are summed into the
+ * ANALYSIS_NUM_BANDS bands given by ANALYSIS_BAND_EDGES_HZ. Energies are in
+ * relative units and saturate at 0xFFFF.
+ */
+
+void analysis_init(void);
+void analysis_process(const uint16_t *block);
+bool analysis_get_bands(uint16_t *bands);
+
+#endif /* S2C_ANALYSIS_H_ */
@@ -0,0 +1,235 @@
+/*
+ * s2c_can_bench.c
+ *
+ * Created: 2026-10-20 11:04:18 AM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_can_bench.h>
+#include <s2c_irq.h>
+#include <s2c_log.h>
+
+#define BENCH_COUNTER_RELOAD	SysTick_LOAD_RELOAD_Msk
+#define BENCH_DRAIN_MS			10 // for the last queued frames to loop back
+#define BENCH_STAMPS			8 // more than the frames in flight, power of 2
+
+static struct can_module *can_module = NULL;
+static struct can_bench_result results[CAN_BENCH_MAX_CASES];
+static uint8_t num_results = 0;
+static uint8_t report_index = 0; // next frame to send, 2 per result
+static uint16_t report_elapsed_ms = 0;
+
+// Written by the RX interrupt
+static volatile uint32_t tx_stamps[BENCH_STAMPS]; // counter reading at each frame's transfer request, by sequence number
+static volatile uint32_t rx_count = 0;
+static volatile uint32_t rx_latency_sum = 0;
+static volatile uint32_t rx_latency_max = 0;
+static volatile uint32_t rx_isr_cycles = 0;
+
+static inline uint32_t bench_elapsed(uint32_t from, uint32_t to) {
+	return s2c_irqstat_elapsed(from, to, BENCH_COUNTER_RELOAD);
+}
+
+static uint8_t payload_dlc(uint8_t payload) {
+	if(payload <= 8) return payload;
+	if(payload <= 24) return 6 + payload / 4; // 12, 16, 20, 24
+	return 11 + payload / 16; // 32, 48, 64
+}
+
+static uint16_t saturate_16(uint32_t value) {
+	return (value > 0xFFFF) ? 0xFFFF : value;
+}
+
+/*
+ * Runs one case and fills its result
+ */
+static void run_case(can_bench_claim_t claim, can_bench_send_t send, struct can_bench_result *result) {
+	uint32_t cycles_per_us = system_cpu_clock_get_hz() / 1000000UL;
+	uint32_t window_cycles = CAN_BENCH_WINDOW_MS * 1000UL * cycles_per_us;
+	uint32_t drain_cycles = BENCH_DRAIN_MS * 1000UL * cycles_per_us;
+	uint32_t buffer_mask = (1UL << result->depth) - 1;
+	uint32_t t1 = CAN_TX_ELEMENT_T1_DLC(payload_dlc(result->payload));
+	if(result->format != CAN_BENCH_CLASSIC) t1 |= CAN_TX_ELEMENT_T1_FDF;
+	if(result->format == CAN_BENCH_FD_BRS) t1 |= CAN_TX_ELEMENT_T1_BRS;
+
+	rx_count = rx_latency_sum = rx_latency_max = rx_isr_cycles = 0;
+	uint32_t sent = 0;
+	uint32_t queue_cycles = 0;
+	uint32_t start = SysTick->VAL;
+	uint32_t elapsed = 0;
+
+	while(elapsed < window_cycles) {
+		for(uint32_t i = 0; i < result->depth; i++) {
+			uint32_t queue_start = SysTick->VAL;
+			struct can_tx_element *tx_elem = claim(i);
+			if(tx_elem == NULL) continue;
+			tx_elem->T0.reg = CAN_TX_ELEMENT_T0_STANDARD_ID(sent & CAN_BENCH_SEQUENCE_MASK);
+			tx_elem->T1.reg = t1;
+			for(uint8_t b = 0; b < result->payload; b++) {
+				tx_elem->data[b] = sent + b;
+			}
+			tx_stamps[sent % BENCH_STAMPS] = SysTick->VAL;
+			send(tx_elem, i);
+			queue_cycles += bench_elapsed(queue_start, SysTick->VAL);
+			++sent;
+		}
+		elapsed = bench_elapsed(start, SysTick->VAL);
+	}
+	uint32_t received = rx_count;
+
+	// Let the frames still queued loop back, so they aren't counted as lost
+	uint32_t drain_start = SysTick->VAL;
+	while(can_tx_get_pending_status(can_module) & buffer_mask) {
+		if(bench_elapsed(drain_start, SysTick->VAL) > drain_cycles) {
+			can_tx_cancel_request(can_module, buffer_mask);
+			break;
+		}
+	}
+	while(rx_count < sent && bench_elapsed(drain_start, SysTick->VAL) < drain_cycles);
+
+	uint32_t total = rx_count;
+	result->frames_per_s = saturate_16(received * 1000000UL / (elapsed / cycles_per_us));
+	result->queue_cycles = (sent > 0) ? saturate_16(queue_cycles / sent) : 0;
+	result->isr_cycles = (total > 0) ? saturate_16(rx_isr_cycles / total) : 0;
+	result->latency_us = (total > 0) ? saturate_16(rx_latency_sum / total / cycles_per_us) : 0;
+	result->max_latency_us = saturate_16(rx_latency_max / cycles_per_us);
+	result->lost = saturate_16(sent - total);
+}
+
+/**
+ * \brief Runs the whole sweep in internal loopback, then puts the module back on the bus
+ *
+ * Blocks for about CAN_BENCH_MAX_CASES * CAN_BENCH_WINDOW_MS. Call with
+ * interrupts enabled, before the main loop sends anything.
+ *
+ * \param module	started CAN module
+ * \param claim		claim_tx_buffer(), the telemetry's TX path
+ * \param send		send_tx_buffer()
+ *
+ */
+void can_bench_run(struct can_module *const module, can_bench_claim_t claim, can_bench_send_t send) {
+	static const uint8_t payloads[CAN_BENCH_NUM_PAYLOADS] = CAN_BENCH_PAYLOADS;
+	static const uint8_t depths[CAN_BENCH_NUM_DEPTHS] = CAN_BENCH_DEPTHS;
+	can_module = module;
+
+	// Take SysTick over as a free-running counter with the longest period
+	uint32_t systick_ctrl = SysTick->CTRL;
+	uint32_t systick_load = SysTick->LOAD;
+	SysTick->CTRL = 0;
+	SysTick->LOAD = BENCH_COUNTER_RELOAD;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+
+	// Internal loopback, and every looped back frame into RX FIFO 0 whatever the filters say
+	can_enable_test_mode(module);
+	can_enable_bus_monitor_mode(module);
+	uint32_t gfc = module->hw->GFC.reg;
+	module->hw->GFC.reg = (gfc & ~CAN_GFC_ANFS_Msk) | CAN_GFC_ANFS(CAN_NONMATCHING_FRAMES_FIFO_0);
+	can_start(module);
+	can_enable_interrupt(module, CAN_RX_FIFO_0_NEW_MESSAGE);
+
+	num_results = 0;
+	for(uint8_t f = 0; f < CAN_BENCH_NUM_FORMATS; f++) {
+		for(uint8_t p = 0; p < CAN_BENCH_NUM_PAYLOADS; p++) {
+			if(payloads[p] > ((f == CAN_BENCH_CLASSIC) ? 8 : CONF_CAN_ELEMENT_DATA_SIZE)) continue;
+			for(uint8_t d = 0; d < CAN_BENCH_NUM_DEPTHS; d++) {
+				struct can_bench_result *result = &results[num_results++];
+				result->format = f;
+				result->payload = payloads[p];
+				result->depth = depths[d];
+				run_case(claim, send, result);
+			}
+		}
+	}
+	S2C_LOG("CAN bench: %u cases", num_results);
+
+	// Back on the bus as configure_can() left it, with nothing of the run left for loop_can_command()
+	can_disable_interrupt(module, CAN_RX_FIFO_0_NEW_MESSAGE);
+	while(can_rx_get_fifo_status(module, 0) & CAN_RXF0S_F0FL_Msk) {
+		can_rx_fifo_acknowledge(module, 0, (can_rx_get_fifo_status(module, 0) & CAN_RXF0S_F0GI_Msk) >> CAN_RXF0S_F0GI_Pos);
+	}
+	can_stop(module);
+	module->hw->CCCR.reg |= CAN_CCCR_CCE;
+	module->hw->TEST.reg &= ~CAN_TEST_LBCK;
+	can_disable_test_mode(module);
+	can_disable_bus_monitor_mode(module);
+	module->hw->GFC.reg = gfc;
+	can_start(module);
+	can_clear_interrupt_status(module, CAN_RX_FIFO_0_NEW_MESSAGE);
+
+	SysTick->CTRL = 0;
+	SysTick->LOAD = systick_load;
+	SysTick->VAL = 0;
+	SysTick->CTRL = systick_ctrl;
+	s2c_irqstat_reset(&irq_stats[IRQ_SOURCE_CAN]);
+
+	report_index = 0;
+	report_elapsed_ms = 0;
+}
+
+/**
+ * \brief Drains RX FIFO 0 during the run, called by the CAN handler on a new message
+ *
+ * \param entry	counter reading at handler entry, from irq_enter()
+ *
+ */
+void can_bench_rx(uint32_t entry) {
+	struct can_rx_element_fifo_0 rx_elem;
+
+	while(can_rx_get_fifo_status(can_module, 0) & CAN_RXF0S_F0FL_Msk) {
+		uint32_t now = SysTick->VAL; // frames after the first arrived after entry
+		uint32_t get_index = (can_rx_get_fifo_status(can_module, 0) & CAN_RXF0S_F0GI_Msk) >> CAN_RXF0S_F0GI_Pos;
+		can_get_rx_fifo_0_element(can_module, &rx_elem, get_index);
+		can_rx_fifo_acknowledge(can_module, 0, get_index);
+
+		uint32_t sequence = (rx_elem.R0.reg >> 18) & CAN_BENCH_SEQUENCE_MASK; // standard ID, bits 28 to 18
+		uint32_t latency = bench_elapsed(tx_stamps[sequence % BENCH_STAMPS], now);
+		rx_latency_sum += latency;
+		if(latency > rx_latency_max) rx_latency_max = latency;
+		++rx_count;
+	}
+	rx_isr_cycles += bench_elapsed(entry, SysTick->VAL);
+}
+
+/**
+ * \brief Starts the report over once per CAN_BENCH_REPORT_PERIOD_MS
+ *
+ * \param elapsed_ms	time since the last call
+ *
+ */
+void can_bench_update(uint16_t elapsed_ms) {
+	report_elapsed_ms += elapsed_ms;
+	if(report_elapsed_ms >= CAN_BENCH_REPORT_PERIOD_MS) {
+		report_elapsed_ms = 0;
+		report_index = 0;
+	}
+}
+
+/**
+ * \brief Gets the next result frame payload
+ *
+ * \param data	8 byte payload buffer
+ *
+ * \return true if data was filled, false if the set has been sent this period
+ *
+ */
+bool can_bench_report(uint8_t *data) {
+	if(report_index >= 2 * num_results) return false;
+
+	const struct can_bench_result *result = &results[report_index / 2];
+	uint8_t part = report_index % 2;
+	++report_index;
+
+	data[0] = result->payload;
+	data[1] = (result->depth & 0xF) | (result->format << 4) | (part << 6) | ((result->lost > 0) ? 0x80 : 0);
+	if(part == 0) {
+		convert_16_bit_to_byte_array(result->frames_per_s, data + 2);
+		convert_16_bit_to_byte_array(result->queue_cycles, data + 4);
+		convert_16_bit_to_byte_array(result->isr_cycles, data + 6);
+	} else {
+		convert_16_bit_to_byte_array(result->latency_us, data + 2);
+		convert_16_bit_to_byte_array(result->max_latency_us, data + 4);
+		convert_16_bit_to_byte_array(result->lost, data + 6);
+	}
+	return true;
+}
@@ -0,0 +1,94 @@
+/*
+ * s2c_can_bench.h
+ *
+ * Created: 2026-10-20 11:04:18 AM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_CAN_BENCH_H_
+#define S2C_CAN_BENCH_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * CAN throughput and latency benchmark (USE_CAN_BENCH).
+ *
+ * Runs once at boot, before the main loop, with the M_CAN in internal
+ * loopback (test mode LBCK with bus monitor mode, so nothing reaches the
+ * pins). Frames go through the same claim_tx_buffer() / send_tx_buffer() path
+ * as the telemetry, and come back through the RX FIFO 0 interrupt. Each case
+ * keeps TX buffers 0 to depth - 1 busy for CAN_BENCH_WINDOW_MS. The frame ID
+ * is its sequence number within the case, so the M_CAN's lowest ID first
+ * choice between pending buffers sends them in queueing order, and payload
+ * byte n is sequence + n.
+ * --> payload sizes: CAN_BENCH_PAYLOADS, up to 8 bytes for classic frames
+ *     and up to CONF_CAN_ELEMENT_DATA_SIZE for FD frames (64 in the FD
+ *     profiles of conf_can.h; at 8 the FD cases stop at 8 bytes too)
+ * --> TX depths: CAN_BENCH_DEPTHS, the number of buffers kept pending
+ * --> frame formats: classic, plus FD and FD with bit rate switching when
+ *     CONF_CAN_FD_ENABLE
+ * and measures:
+ * --> frames/s looped back
+ * --> CPU cycles to queue one frame (claim, fill the payload, send)
+ * --> RX interrupt cycles per frame (read the FIFO element, acknowledge)
+ * --> latency from the transfer request to the RX interrupt taking the
+ *     frame, which includes queueing behind the other buffers when depth > 1
+ * --> frames lost, sent but never received
+ * SysTick is the cycle counter, so it is taken over for the run (full
+ * period, interrupt off) and restored afterwards; the sampler misses its
+ * ticks meanwhile.
+ *
+ * Results go out as two frames per case on CAN_MSG_ID(id, CAN_MSG_BENCH),
+ * one per loop, the whole set once per CAN_BENCH_REPORT_PERIOD_MS:
+ * byte 0: payload bytes, byte 1: bits 0 to 3: TX depth, bits 4 & 5: enum
+ * can_bench_format, bit 6: part, bit 7: frames were lost
+ * - part 0: bytes 2 & 3: frames/s, bytes 4 & 5: queue cycles per frame,
+ *   bytes 6 & 7: RX interrupt cycles per frame
+ * - part 1: bytes 2 & 3: mean latency in us, bytes 4 & 5: max latency in us,
+ *   bytes 6 & 7: frames lost
+ * tools/s2c_can_bench.py decodes them from a CAN log and puts them next to
+ * a bit-level bus model of the same frames, which gives the bus's limit for
+ * each case, not a prediction of the measurement.
+ */
+
+enum can_bench_format {
+	CAN_BENCH_CLASSIC,
+	CAN_BENCH_FD,		// FD frame, data phase at the nominal bitrate
+	CAN_BENCH_FD_BRS	// FD frame, data phase at the data bitrate
+};
+
+#if CONF_CAN_FD_ENABLE
+#define CAN_BENCH_NUM_FORMATS	3
+#else
+#define CAN_BENCH_NUM_FORMATS	1
+#endif
+#define CAN_BENCH_PAYLOADS		{ 0, 4, 8, 16, 32, 64 }
+#define CAN_BENCH_NUM_PAYLOADS	6
+#define CAN_BENCH_DEPTHS		{ 1, 2, 4, CONF_CAN0_TX_BUFFER_NUM }
+#define CAN_BENCH_NUM_DEPTHS	4
+#define CAN_BENCH_MAX_CASES		(CAN_BENCH_NUM_FORMATS * CAN_BENCH_NUM_PAYLOADS * CAN_BENCH_NUM_DEPTHS)
+#define CAN_BENCH_SEQUENCE_MASK	0x7FF // loopback frame IDs, they never leave the chip
+
+struct can_bench_result {
+	uint8_t payload;
+	uint8_t depth;
+	uint8_t format;			// enum can_bench_format
+	uint16_t frames_per_s;
+	uint16_t queue_cycles;	// mean
+	uint16_t isr_cycles;	// mean, per frame
+	uint16_t latency_us;	// mean
+	uint16_t max_latency_us;
+	uint16_t lost;
+};
+
+typedef struct can_tx_element *(*can_bench_claim_t)(uint32_t index);
+typedef void (*can_bench_send_t)(struct can_tx_element *tx_elem, uint32_t index);
+
+void can_bench_run(struct can_module *const module, can_bench_claim_t claim, can_bench_send_t send);
+void can_bench_rx(uint32_t entry);
+void can_bench_update(uint16_t elapsed_ms);
+bool can_bench_report(uint8_t *data);
+
+#endif /* S2C_CAN_BENCH_H_ */
@@ -0,0 +1,185 @@
+/*
+ * s2c_can_health.c
+ *
+ * Created: 2026-10-19 9:02:41 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_can_health.h>
+#include <s2c_log.h>
+
+static struct can_module *can_module = NULL;
+static enum can_health_state health_state = CAN_HEALTH_ACTIVE;
+static uint8_t bus_off_count = 0;
+static uint16_t recovery_backoff_ms = CAN_BUS_OFF_RECOVERY_MS; // wait before the next restart
+static uint16_t recovery_wait_ms = 0; // left of the current bus-off's wait
+static bool restarted = false; // can_start() issued by the last update, a bus-off now is a new one
+static uint16_t active_ms = 0; // time error active since the last bus-off recovery
+static uint16_t passive_tx_wait_ms = 0;
+static uint16_t report_elapsed_ms = 0;
+static bool report_due = false;
+
+// Written by the CAN interrupt
+static volatile uint8_t lec_counts[8] = {0}; // per error code, since the last health frame
+static volatile uint8_t last_lec = CAN_PSR_LEC_NONE_Val;
+
+/**
+ * \brief Sets up the health manager for a started CAN module
+ *
+ * \param module	CAN module to watch and recover
+ *
+ */
+void can_health_init(struct can_module *const module) {
+	can_module = module;
+}
+
+static void count_lec(uint8_t lec) {
+	if(lec == CAN_PSR_LEC_NONE_Val || lec == CAN_PSR_LEC_NC_Val) return;
+	if(lec_counts[lec] < 0xFF) ++lec_counts[lec];
+	last_lec = lec;
+}
+
+/**
+ * \brief Counts the error codes of a protocol error interrupt
+ *
+ * Call from the CAN interrupt with the protocol status register, which
+ * must not be read anywhere else since reading it resets the error codes.
+ *
+ * \param psr	protocol status register
+ *
+ */
+void can_health_protocol_error(uint32_t psr) {
+	count_lec((psr & CAN_PSR_LEC_Msk) >> CAN_PSR_LEC_Pos);
+	count_lec((psr & CAN_PSR_DLEC_Msk) >> CAN_PSR_DLEC_Pos);
+}
+
+static enum can_health_state read_state(void) {
+	if(can_module->hw->CCCR.reg & CAN_CCCR_INIT) return CAN_HEALTH_BUS_OFF;
+
+	uint32_t ecr = can_read_error_count(can_module);
+	uint8_t tec = (ecr & CAN_ECR_TEC_Msk) >> CAN_ECR_TEC_Pos;
+	uint8_t rec = (ecr & CAN_ECR_REC_Msk) >> CAN_ECR_REC_Pos;
+	if(tec > 127 || (ecr & CAN_ECR_RP)) return CAN_HEALTH_PASSIVE;
+	if(tec >= 96 || rec >= 96) return CAN_HEALTH_WARNING;
+	return CAN_HEALTH_ACTIVE;
+}
+
+/**
+ * \brief Tracks the error state and restarts the module after a bus-off
+ *
+ * Runs in the main loop, once per loop.
+ *
+ * \param elapsed_ms	time since the last call
+ *
+ */
+void can_health_update(uint16_t elapsed_ms) {
+	if(can_module == NULL) return;
+
+	enum can_health_state state = read_state();
+	if(state != health_state) {
+		S2C_LOG("CAN state %u -> %u", health_state, state);
+	}
+	// On a shorted bus the restart goes bus-off again within a few ms, before
+	// this runs again, so the state never looks like it left bus-off
+	if(state == CAN_HEALTH_BUS_OFF && (health_state != CAN_HEALTH_BUS_OFF || restarted)) {
+		if(bus_off_count < 0xFF) ++bus_off_count;
+		recovery_wait_ms = recovery_backoff_ms;
+	}
+	health_state = state;
+	restarted = false;
+
+	switch(state) {
+	case CAN_HEALTH_BUS_OFF:
+		if(recovery_wait_ms > elapsed_ms) {
+			recovery_wait_ms -= elapsed_ms;
+			break;
+		}
+		// The M_CAN rejoins after 129 x 11 recessive bits on its own
+		can_start(can_module);
+		restarted = true;
+		recovery_backoff_ms = (2 * recovery_backoff_ms < CAN_BUS_OFF_RECOVERY_MAX_MS) ?
+				2 * recovery_backoff_ms : CAN_BUS_OFF_RECOVERY_MAX_MS;
+		active_ms = 0;
+		break;
+
+	case CAN_HEALTH_PASSIVE:
+		passive_tx_wait_ms = (passive_tx_wait_ms > elapsed_ms) ? passive_tx_wait_ms - elapsed_ms : 0;
+		break;
+
+	case CAN_HEALTH_ACTIVE:
+		if(active_ms < CAN_BUS_OFF_RECOVERY_MAX_MS) {
+			active_ms += elapsed_ms;
+		} else {
+			recovery_backoff_ms = CAN_BUS_OFF_RECOVERY_MS;
+		}
+		break;
+
+	case CAN_HEALTH_WARNING:
+		break;
+	}
+
+	report_elapsed_ms += elapsed_ms;
+	if(report_elapsed_ms >= CAN_HEALTH_PERIOD_MS) {
+		report_elapsed_ms = 0;
+		report_due = true;
+	}
+}
+
+/**
+ * \brief Checks whether a frame may be queued in a TX buffer now
+ *
+ * While error passive this hands out one frame 1 slot per
+ * CAN_PASSIVE_TX_INTERVAL_MS, so only ask when about to send.
+ *
+ * \param index	TX buffer index
+ *
+ * \return true if the frame may be queued
+ *
+ */
+bool can_health_tx_allowed(uint32_t index) {
+	switch(health_state) {
+	case CAN_HEALTH_BUS_OFF:
+		return false;
+
+	case CAN_HEALTH_PASSIVE:
+		if(index == CAN_TX_BUFFER_DEBUG) return report_due;
+		if(index != 0 || passive_tx_wait_ms > 0) return false; // buffer 0: frame 1 / summary
+		passive_tx_wait_ms = CAN_PASSIVE_TX_INTERVAL_MS;
+		return true;
+
+	default:
+		return true;
+	}
+}
+
+bool can_health_report_due(void) {
+	return report_due;
+}
+
+/**
+ * \brief Builds the health frame and restarts the error statistics
+ *
+ * \param data	8 byte payload buffer
+ *
+ */
+void can_health_report(uint8_t *data) {
+	uint32_t ecr = can_read_error_count(can_module);
+	data[0] = health_state | (last_lec << 2) | (((bus_off_count < 7) ? bus_off_count : 7) << 5);
+	data[1] = (ecr & CAN_ECR_TEC_Msk) >> CAN_ECR_TEC_Pos;
+	data[2] = ((ecr & CAN_ECR_REC_Msk) >> CAN_ECR_REC_Pos) | ((ecr & CAN_ECR_RP) ? 0x80 : 0);
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	data[3] = lec_counts[CAN_PSR_LEC_STUFF_Val];
+	data[4] = lec_counts[CAN_PSR_LEC_FORM_Val];
+	data[5] = lec_counts[CAN_PSR_LEC_ACK_Val];
+	uint16_t bit_errors = lec_counts[CAN_PSR_LEC_BIT1_Val] + lec_counts[CAN_PSR_LEC_BIT0_Val];
+	data[6] = (bit_errors < 0xFF) ? bit_errors : 0xFF;
+	data[7] = lec_counts[CAN_PSR_LEC_CRC_Val];
+	for(int i = 0; i < 8; i++) {
+		lec_counts[i] = 0;
+	}
+	__set_PRIMASK(primask);
+
+	report_due = false;
+}
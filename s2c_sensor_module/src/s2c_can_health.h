@@ -0,0 +1,52 @@
+/*
+ * s2c_can_health.h
+ *
+ * Created: 2026-10-19 9:02:41 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_CAN_HEALTH_H_
+#define S2C_CAN_HEALTH_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * CAN health manager.
+ *
+ * The error state comes from the error counters once per loop. Bus-off
+ * stops the M_CAN (CCCR.INIT), and it is restarted after a recovery wait
+ * that doubles with every bus-off, from CAN_BUS_OFF_RECOVERY_MS up to
+ * CAN_BUS_OFF_RECOVERY_MAX_MS, and drops back once the bus has been error
+ * active for CAN_BUS_OFF_RECOVERY_MAX_MS. While error passive only frame 1
+ * (or the summary), at most every CAN_PASSIVE_TX_INTERVAL_MS, and the health
+ * frame are sent, so a node stuck retransmitting doesn't crowd the bus. The
+ * alarm frame (s2c_alarm.h) doesn't ask, it goes out whatever the state but
+ * bus-off.
+ * Frames already waiting in a TX buffer are kept and go out once the bus is
+ * back.
+ *
+ * Health frame (CAN_MSG_HEALTH), every CAN_HEALTH_PERIOD_MS:
+ * byte 0: bits 0 & 1: state, bits 2 to 4: last error code (LEC),
+ *         bits 5 to 7: bus-offs since boot (saturated)
+ * byte 1: transmit error counter, byte 2: receive error counter (bit 7: receive error passive)
+ * bytes 3 to 7: stuff, form, ack, bit (recessive or dominant) and CRC errors
+ * since the last health frame (saturated)
+ */
+
+enum can_health_state {
+	CAN_HEALTH_ACTIVE,
+	CAN_HEALTH_WARNING, // a counter reached 96
+	CAN_HEALTH_PASSIVE, // a counter passed 127
+	CAN_HEALTH_BUS_OFF
+};
+
+void can_health_init(struct can_module *const module);
+void can_health_protocol_error(uint32_t psr);
+void can_health_update(uint16_t elapsed_ms);
+bool can_health_tx_allowed(uint32_t index);
+bool can_health_report_due(void);
+void can_health_report(uint8_t *data);
+
+#endif /* S2C_CAN_HEALTH_H_ */
@@ -0,0 +1,163 @@
+/*
+ * s2c_capture.c
+ *
+ * Created: 2026-10-19 11:26:05 AM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_capture.h>
+#include <s2c_irq.h>
+
+enum capture_state {
+	CAPTURE_FILLING,	// ring doesn't hold a full pre-trigger history yet
+	CAPTURE_ARMED,
+	CAPTURE_TRIGGERED,	// recording post-trigger samples
+	CAPTURE_FROZEN		// window complete, waiting to be drained
+};
+
+static uint16_t capture_ring[CAPTURE_LENGTH];
+static volatile uint16_t capture_head = 0; // next ring index to write
+static volatile uint16_t capture_count = 0;
+static volatile enum capture_state capture_state = CAPTURE_FILLING;
+static volatile enum capture_trigger_source capture_source;
+
+static uint16_t capture_prev = 0;
+static uint8_t capture_number = 0;
+
+// Drain position, in samples from the start of the window. -1 means the header is next
+static int16_t drain_offset = -1;
+
+void capture_window_callback(struct adc_module *const module);
+
+/**
+ * \brief Sets up the trigger sources
+ *
+ * Must be called after the ADC has been configured. Samples are fed in through
+ * capture_sample(), normally as the sampler hook.
+ *
+ */
+void capture_init(struct adc_module *const module) {
+#if CAPTURE_USE_WINDOW_MONITOR
+	adc_set_window_mode(module, ADC_WINDOW_MODE_BETWEEN_INVERTED,
+		CAPTURE_THRESHOLD_LOW, CAPTURE_THRESHOLD_HIGH);
+	adc_register_callback(module, capture_window_callback, ADC_CALLBACK_WINDOW);
+	adc_enable_callback(module, ADC_CALLBACK_WINDOW);
+#else
+	UNUSED(module);
+#endif
+}
+
+RAMFUNC void capture_window_callback(struct adc_module *const module) {
+	uint32_t entry = irq_enter();
+	UNUSED(module);
+	capture_trigger(CAPTURE_TRIGGER_WINDOW);
+	irq_exit(IRQ_SOURCE_ADC, entry);
+}
+
+/**
+ * \brief Latches a trigger if the capture is armed. Safe to call from interrupts
+ *
+ * The window callback (ADC priority) can be preempted by the SysTick sampler
+ * between the check and the update, and the sampler may trigger or count down
+ * the post-trigger samples meanwhile, so the handoff runs with interrupts off.
+ *
+ */
+RAMFUNC void capture_trigger(enum capture_trigger_source source) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(capture_state == CAPTURE_ARMED) {
+		capture_source = source;
+		capture_count = CAPTURE_POST_SAMPLES;
+		capture_state = CAPTURE_TRIGGERED;
+	}
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Adds one sample to the ring and checks the software triggers
+ *
+ * Called from the sampler's SysTick handler.
+ *
+ */
+RAMFUNC void capture_sample(uint16_t sample) {
+	if(capture_state == CAPTURE_FROZEN) return;
+
+	capture_ring[capture_head] = sample;
+	capture_head = (capture_head + 1) % CAPTURE_LENGTH;
+
+	switch(capture_state) {
+	case CAPTURE_FILLING:
+		if(++capture_count >= CAPTURE_LENGTH) {
+			capture_state = CAPTURE_ARMED;
+		}
+		break;
+
+	case CAPTURE_ARMED:
+#if !CAPTURE_USE_WINDOW_MONITOR
+		if(sample < CAPTURE_THRESHOLD_LOW || sample > CAPTURE_THRESHOLD_HIGH) {
+			capture_trigger(CAPTURE_TRIGGER_THRESHOLD);
+			break;
+		}
+#endif
+		if(abs((int16_t)sample - (int16_t)capture_prev) > CAPTURE_DERIVATIVE_LIMIT) {
+			capture_trigger(CAPTURE_TRIGGER_DERIVATIVE);
+		}
+		break;
+
+	case CAPTURE_TRIGGERED:
+		if(--capture_count == 0) {
+			capture_state = CAPTURE_FROZEN;
+		}
+		break;
+
+	default:
+		break;
+	}
+	capture_prev = sample;
+}
+
+/**
+ * \brief Gets the next payload of a frozen capture
+ *
+ * Runs in the main loop. Once the last payload has been handed out the capture
+ * starts refilling its history and re-arms.
+ *
+ * \param data 8 byte payload buffer
+ *
+ * \return true if data was filled, false if there is nothing to send
+ *
+ */
+bool capture_drain(uint8_t *data) {
+	if(capture_state != CAPTURE_FROZEN) {
+		return false;
+	}
+
+	if(drain_offset < 0) {
+		convert_16_bit_to_byte_array(CAPTURE_HEADER_MARKER, data);
+		convert_16_bit_to_byte_array(CAPTURE_PRE_SAMPLES, data + 2);
+		convert_16_bit_to_byte_array(CAPTURE_POST_SAMPLES, data + 4);
+		data[6] = capture_source;
+		data[7] = capture_number;
+		drain_offset = 0;
+		return true;
+	}
+
+	// The oldest sample of the window sits at capture_head
+	convert_16_bit_to_byte_array(drain_offset, data);
+	for(int i = 0; i < CAPTURE_SAMPLES_PER_FRAME; i++) {
+		uint16_t sample = 0;
+		if(drain_offset + i < CAPTURE_LENGTH) {
+			sample = capture_ring[(capture_head + drain_offset + i) % CAPTURE_LENGTH];
+		}
+		convert_16_bit_to_byte_array(sample, data + 2 + 2 * i);
+	}
+	drain_offset += CAPTURE_SAMPLES_PER_FRAME;
+
+	if(drain_offset >= CAPTURE_LENGTH) {
+		drain_offset = -1;
+		++capture_number;
+		capture_count = 0;
+		capture_state = CAPTURE_FILLING;
+	}
+	return true;
+}
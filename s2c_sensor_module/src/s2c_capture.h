@@ -0,0 +1,49 @@
+/*
+ * s2c_capture.h
+ *
+ * Created: 2026-10-19 11:26:05 AM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_CAPTURE_H_
+#define S2C_CAPTURE_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Event-triggered capture of the suspension signal.
+ *
+ * Every sampler sample goes into a CAPTURE_LENGTH ring. Once the ring has been
+ * filled the capture arms, and any of these triggers it:
+ * --> sample outside CAPTURE_THRESHOLD_LOW..CAPTURE_THRESHOLD_HIGH
+ *     (ADC window monitor if CAPTURE_USE_WINDOW_MONITOR, software compare otherwise)
+ * --> sample to sample change larger than CAPTURE_DERIVATIVE_LIMIT
+ * After CAPTURE_POST_SAMPLES more samples the ring is frozen, leaving
+ * CAPTURE_PRE_SAMPLES of history before the trigger. The main loop then drains
+ * it frame by frame with capture_drain() and the capture re-arms.
+ *
+ * Drained payloads (8 bytes each):
+ * - header: bytes 0 & 1: 0xFFFF, bytes 2 & 3: pre-trigger samples,
+ *           bytes 4 & 5: post-trigger samples, byte 6: trigger source,
+ *           byte 7: capture number
+ * - data:   bytes 0 & 1: offset of the first sample in the window,
+ *           bytes 2 to 7: three samples
+ */
+
+enum capture_trigger_source {
+	CAPTURE_TRIGGER_THRESHOLD,
+	CAPTURE_TRIGGER_DERIVATIVE,
+	CAPTURE_TRIGGER_WINDOW
+};
+
+#define CAPTURE_HEADER_MARKER		0xFFFF
+#define CAPTURE_SAMPLES_PER_FRAME	3
+
+void capture_init(struct adc_module *const module);
+void capture_sample(uint16_t sample);
+void capture_trigger(enum capture_trigger_source source);
+bool capture_drain(uint8_t *data);
+
+#endif /* S2C_CAPTURE_H_ */
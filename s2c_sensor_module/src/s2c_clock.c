@@ -0,0 +1,111 @@
+/*
+ * s2c_clock.c
+ *
+ * Created: 2026-10-19 9:58:12 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_clock.h>
+#include <s2c_log.h>
+
+// Flash wait states for a CPU clock, from the SAMC21 NVM characteristics (2.7 V to 5.5 V)
+#define CLOCK_WAIT_STATES(hz)	(((hz) <= 19000000UL) ? 0 : ((hz) <= 38000000UL) ? 1 : 2)
+
+// Polls of the XOSC / DPLL ready flags before giving up on the crystal
+#define CLOCK_READY_TIMEOUT		100000UL
+
+// DPLL reference, at most 2 MHz: XOSC / (2 * (divider + 1))
+#define CLOCK_DPLL_REF_DIVIDER	((CONF_CLOCK_XOSC_EXTERNAL_FREQUENCY + 3999999UL) / 4000000UL - 1)
+
+static const uint8_t cpu_dividers[] = {
+	[S2C_CLOCK_BALANCED] = 3,
+	[S2C_CLOCK_LOW_POWER] = 6,
+	[S2C_CLOCK_FULL_SPEED] = 1
+};
+
+static bool wait_ready(enum system_clock_source source) {
+	for(uint32_t i = 0; i < CLOCK_READY_TIMEOUT; i++) {
+		if(system_clock_source_is_ready(source)) return true;
+	}
+	return false;
+}
+
+#if USE_XOSC_CAN_CLOCK
+/**
+ * \brief Moves GCLK_CAN onto the DPLL locked to the crystal
+ *
+ * \return true if the DPLL locked, false if CAN was left on OSC48M
+ *
+ */
+static bool clock_start_xosc_can(void) {
+	struct system_clock_source_xosc_config xosc_conf;
+	system_clock_source_xosc_get_config_defaults(&xosc_conf);
+	xosc_conf.external_clock = CONF_CLOCK_XOSC_EXTERNAL_CRYSTAL;
+	xosc_conf.frequency = CONF_CLOCK_XOSC_EXTERNAL_FREQUENCY;
+	xosc_conf.startup_time = SYSTEM_XOSC_STARTUP_4096;
+	xosc_conf.auto_gain_control = true;
+	xosc_conf.on_demand = false;
+	xosc_conf.clock_failure_detector_prescaler = SYSTEM_CLOCK_XOSC_FAILURE_DETECTOR_PRESCALER_4;
+	xosc_conf.enable_clock_failure_detector = true;
+	xosc_conf.enable_clock_switch_back = true;
+	system_clock_source_xosc_set_config(&xosc_conf);
+	system_clock_source_enable(SYSTEM_CLOCK_SOURCE_XOSC);
+	if(!wait_ready(SYSTEM_CLOCK_SOURCE_XOSC)) {
+		system_clock_source_disable(SYSTEM_CLOCK_SOURCE_XOSC);
+		return false;
+	}
+
+	struct system_clock_source_dpll_config dpll_conf;
+	system_clock_source_dpll_get_config_defaults(&dpll_conf);
+	dpll_conf.on_demand = false;
+	dpll_conf.reference_clock = SYSTEM_CLOCK_SOURCE_DPLL_REFERENCE_CLOCK_XOSC;
+	dpll_conf.reference_frequency = CONF_CLOCK_XOSC_EXTERNAL_FREQUENCY;
+	dpll_conf.reference_divider = CLOCK_DPLL_REF_DIVIDER;
+	dpll_conf.output_frequency = CONF_CAN_GCLK_HZ;
+	system_clock_source_dpll_set_config(&dpll_conf);
+	system_clock_source_enable(SYSTEM_CLOCK_SOURCE_DPLL);
+	if(!wait_ready(SYSTEM_CLOCK_SOURCE_DPLL)) {
+		system_clock_source_disable(SYSTEM_CLOCK_SOURCE_DPLL);
+		system_clock_source_disable(SYSTEM_CLOCK_SOURCE_XOSC);
+		return false;
+	}
+
+	struct system_gclk_gen_config gen_conf;
+	system_gclk_gen_get_config_defaults(&gen_conf);
+	gen_conf.source_clock = SYSTEM_CLOCK_SOURCE_DPLL;
+	gen_conf.division_factor = 1;
+	system_gclk_gen_set_config(GCLK_GENERATOR_8, &gen_conf);
+	return true;
+}
+#endif
+
+/**
+ * \brief Switches the CPU clock to a profile, see s2c_clock.h
+ *
+ * \param profile	clock profile
+ *
+ */
+void clock_set_profile(enum s2c_clock_profile profile) {
+	uint32_t cpu_hz = CLOCK_OSC48M_HZ / cpu_dividers[profile];
+	uint8_t wait_states = CLOCK_WAIT_STATES(cpu_hz);
+
+	// Add wait states before speeding up, drop them after slowing down
+	if(wait_states > NVMCTRL->CTRLB.bit.RWS) {
+		system_flash_set_waitstates(wait_states);
+	}
+
+	struct system_gclk_gen_config gen_conf;
+	system_gclk_gen_get_config_defaults(&gen_conf);
+	gen_conf.source_clock = SYSTEM_CLOCK_SOURCE_OSC48M;
+	gen_conf.division_factor = cpu_dividers[profile];
+	system_gclk_gen_set_config(GCLK_GENERATOR_0, &gen_conf);
+
+	system_flash_set_waitstates(wait_states);
+
+#if USE_XOSC_CAN_CLOCK
+	if(!clock_start_xosc_can()) {
+		S2C_LOG("clock: crystal didn't start, CAN stays on OSC48M");
+	}
+#endif
+	S2C_LOG("clock: profile %u, CPU %u kHz, %u wait states", profile, (uint16_t)(cpu_hz / 1000), wait_states);
+}
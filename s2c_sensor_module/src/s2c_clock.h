@@ -0,0 +1,39 @@
+/*
+ * s2c_clock.h
+ *
+ * Created: 2026-10-19 9:58:12 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_CLOCK_H_
+#define S2C_CLOCK_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Clock profiles.
+ *
+ * conf_clocks.h boots every board with OSC48M undivided: GCLK0 (CPU, ADC,
+ * SERCOM) at 16 MHz and GCLK8 (CAN) at 48 MHz. Once the board type is known,
+ * clock_set_profile() sets the CPU speed the board needs:
+ * --> S2C_CLOCK_LOW_POWER: 8 MHz, for boards that only poll slow sensors
+ * --> S2C_CLOCK_BALANCED: 16 MHz, the boot clock
+ * --> S2C_CLOCK_FULL_SPEED: 48 MHz, for the fixed-rate sampler and its DSP
+ * Flash wait states follow the CPU clock. GCLK_CAN stays at the same
+ * frequency in every profile, so the bit timing in conf_can.h holds.
+ *
+ * With USE_XOSC_CAN_CLOCK, GCLK_CAN comes from the DPLL locked to the
+ * crystal instead of the RC oscillator. If the crystal doesn't start, CAN
+ * stays on OSC48M. If it fails later, the clock failure detector swaps in
+ * OSC48M / 4 (12 MHz, same as the crystal) and the DPLL keeps running.
+ *
+ * Call before any peripheral is configured, they read their clocks at init.
+ */
+
+#define CLOCK_OSC48M_HZ		48000000UL
+
+void clock_set_profile(enum s2c_clock_profile profile);
+
+#endif /* S2C_CLOCK_H_ */
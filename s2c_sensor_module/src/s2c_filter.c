@@ -0,0 +1,128 @@
+/*
+ * s2c_filter.c
+ *
+ * Created: 2026-10-19 9:12:40 AM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_filter.h>
+
+// Shift between 10-bit ADC counts and q15. Leaves the sign bit clear so full scale doesn't wrap.
+#define FILTER_Q15_SHIFT		5
+
+#define FILTER_CHUNK_OUTPUTS	(ADC_FILTER_BLOCK_SIZE / ADC_FILTER_DECIMATION)
+#define FILTER_BLOCK_OUTPUTS	(SAMPLER_BLOCK_SIZE / ADC_FILTER_DECIMATION)
+
+/*
+ * 2nd order Butterworth low-pass, fc = 0.05 * fs.
+ * CMSIS q15 layout is {b0, 0, b1, b2, a1, a2} with postShift = 1, i.e. Q14 coefficients,
+ * and the feedback terms are negated (y[n] = ... + a1 * y[n-1] + a2 * y[n-2]).
+ */
+static q15_t biquad_coeffs[6 * ADC_FILTER_BIQUAD_STAGES] = {
+	329, 0, 658, 329, 25576, -10508
+};
+
+/*
+ * 16-tap Hamming windowed-sinc anti-alias FIR for the decimator, fc = 0.1 * fs.
+ * Taps sum to unity gain in q15.
+ */
+static q15_t decimate_coeffs[ADC_FILTER_FIR_TAPS] = {
+	-114, -159, -139, 291, 1450, 3284, 5246, 6524,
+	6524, 5246, 3284, 1450, 291, -139, -159, -114
+};
+
+static arm_biquad_casd_df1_inst_q15 biquad_instance;
+static arm_fir_decimate_instance_q15 decimate_instance;
+static q15_t biquad_state[4 * ADC_FILTER_BIQUAD_STAGES];
+static q15_t decimate_state[ADC_FILTER_FIR_TAPS + ADC_FILTER_BLOCK_SIZE - 1];
+static bool primed = false;
+
+// Scratch buffers, only used from filter_process()
+static q15_t filter_in[ADC_FILTER_BLOCK_SIZE];
+static q15_t filter_lp[ADC_FILTER_BLOCK_SIZE];
+static q15_t filter_out[FILTER_CHUNK_OUTPUTS];
+
+// Decimated samples of the last block, until filter_drain() has sent them
+static uint16_t block_outputs[FILTER_BLOCK_OUTPUTS];
+static uint16_t block_number = 0; // stream number of block_outputs[0]
+static uint8_t drain_index = FILTER_BLOCK_OUTPUTS;
+
+/**
+ * \brief Sets up the biquad and decimator, the stream starts at the next block
+ */
+void filter_init(void) {
+	arm_biquad_cascade_df1_init_q15(&biquad_instance, ADC_FILTER_BIQUAD_STAGES, biquad_coeffs, biquad_state, 1);
+
+	arm_status status = arm_fir_decimate_init_q15(&decimate_instance, ADC_FILTER_FIR_TAPS,
+		ADC_FILTER_DECIMATION, decimate_coeffs, decimate_state, ADC_FILTER_BLOCK_SIZE);
+	Assert(status == ARM_MATH_SUCCESS);
+	UNUSED(status);
+
+	primed = false;
+	block_number = 0;
+	drain_index = FILTER_BLOCK_OUTPUTS;
+}
+
+/**
+ * \brief Filters and decimates the next block of the sampler stream
+ *
+ * Must be called from the main loop, on every block in sampler order.
+ *
+ * \param block		SAMPLER_BLOCK_SIZE raw samples
+ *
+ */
+void filter_process(const uint16_t *block) {
+	// Start at steady state on the first sample instead of ramping up from 0. Both filters
+	// have unity DC gain, DF1 state is {x[n-1], x[n-2], y[n-1], y[n-2]} per stage and the
+	// decimator keeps its last ADC_FILTER_FIR_TAPS - 1 inputs up front
+	if(!primed) {
+		q15_t start = (q15_t)(block[0] << FILTER_Q15_SHIFT);
+		for(int i = 0; i < 4 * ADC_FILTER_BIQUAD_STAGES; i++) {
+			biquad_state[i] = start;
+		}
+		for(int i = 0; i < ADC_FILTER_FIR_TAPS - 1; i++) {
+			decimate_state[i] = start;
+		}
+		primed = true;
+	} else {
+		block_number += FILTER_BLOCK_OUTPUTS;
+	}
+
+	for(int chunk = 0; chunk < SAMPLER_BLOCK_SIZE / ADC_FILTER_BLOCK_SIZE; chunk++) {
+		const uint16_t *samples = block + chunk * ADC_FILTER_BLOCK_SIZE;
+		for(int i = 0; i < ADC_FILTER_BLOCK_SIZE; i++) {
+			filter_in[i] = (q15_t)(samples[i] << FILTER_Q15_SHIFT);
+		}
+
+		arm_biquad_cascade_df1_q15(&biquad_instance, filter_in, filter_lp, ADC_FILTER_BLOCK_SIZE);
+		arm_fir_decimate_q15(&decimate_instance, filter_lp, filter_out, ADC_FILTER_BLOCK_SIZE);
+
+		uint16_t *outputs = block_outputs + chunk * FILTER_CHUNK_OUTPUTS;
+		for(int i = 0; i < FILTER_CHUNK_OUTPUTS; i++) {
+			// Filter overshoot can dip just below zero on a grounded input
+			int32_t rounded = (filter_out[i] + (1 << (FILTER_Q15_SHIFT - 1))) >> FILTER_Q15_SHIFT;
+			outputs[i] = (rounded < 0) ? 0 : rounded;
+		}
+	}
+	drain_index = 0;
+}
+
+/**
+ * \brief Gets the next CAN_MSG_FILTER payload of the last block
+ *
+ * \param data	8 byte payload buffer
+ *
+ * \return payload length in bytes, 0 once the block has been drained
+ *
+ */
+uint8_t filter_drain(uint8_t *data) {
+	if(drain_index >= FILTER_BLOCK_OUTPUTS) return 0;
+
+	convert_16_bit_to_byte_array(block_number + drain_index, data);
+	uint8_t length = 2;
+	for(int i = 0; i < FILTER_SAMPLES_PER_FRAME && drain_index < FILTER_BLOCK_OUTPUTS; i++) {
+		convert_16_bit_to_byte_array(block_outputs[drain_index++], data + length);
+		length += 2;
+	}
+	return length;
+}
@@ -0,0 +1,51 @@
+/*
+ * s2c_filter.h
+ *
+ * Created: 2026-10-19 9:12:40 AM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_FILTER_H_
+#define S2C_FILTER_H_
+
+#include <asf.h>
+#include <arm_math.h>
+#include <s2c_utils.h>
+
+/*
+ * Fixed-point low-pass filtering and decimation of the suspension signal.
+ *
+ * With use_filter the sampler (s2c_sampler.h) samples ADC channel 0 at
+ * SAMPLER_RATE_HZ, and the main loop hands every block it takes to
+ * filter_process(). The block goes, ADC_FILTER_BLOCK_SIZE samples at a time, through:
+ * --> a q15 low-pass biquad cascade (arm_biquad_cascade_df1_q15)
+ * --> a q15 decimating FIR (arm_fir_decimate_q15), by ADC_FILTER_DECIMATION
+ * Both filters carry their state from one call to the next, so the blocks
+ * make up one continuous stream at SAMPLER_RATE_HZ / ADC_FILTER_DECIMATION.
+ * The filters start from steady state at the first sample after filter_init().
+ *
+ * Response, with fs the sample rate (tests/test_filter.c checks it):
+ * --> passband: within 0.5 dB up to 0.02 * fs
+ * --> stopband: at least 24 dB down from the decimated Nyquist (fs / 8) up
+ * --> step: within 1% of the final value after FILTER_SETTLE_OUTPUTS
+ *     decimated samples, overshoot below 5%
+ *
+ * The main loop drains the decimated samples of a block with filter_drain(),
+ * one CAN_MSG_FILTER payload per call (2 to 8 bytes):
+ * --> bytes 0 & 1: number of the first sample in the stream, wraps at 65536
+ * --> bytes 2 to 7: up to FILTER_SAMPLES_PER_FRAME samples, in ADC counts
+ * A block that arrives before the last one is drained replaces it, and the
+ * receiver sees the loss as a jump in the sample numbers.
+ *
+ * Nothing in here is called from interrupt context.
+ */
+
+#define FILTER_SAMPLES_PER_FRAME	3
+#define FILTER_SETTLE_OUTPUTS		10
+
+void filter_init(void);
+void filter_process(const uint16_t *block);
+uint8_t filter_drain(uint8_t *data);
+
+#endif /* S2C_FILTER_H_ */
@@ -0,0 +1,54 @@
+/*
+ * s2c_irq.c
+ *
+ * Created: 2026-10-19 6:03:52 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_irq.h>
+
+// Global so it can also be read with a debugger
+struct s2c_irqstat irq_stats[IRQ_NUM_SOURCES];
+
+/**
+ * \brief Applies the interrupt priority plan and starts the cycle counter
+ *
+ * Must run after sampler_init(), since SysTick_Config() resets the SysTick priority.
+ *
+ */
+void irq_init(void) {
+	system_interrupt_set_priority(SYSTEM_INTERRUPT_SYSTICK, IRQ_PRIORITY_TIMER);
+	system_interrupt_set_priority(SYSTEM_INTERRUPT_MODULE_ADC0, IRQ_PRIORITY_ADC);
+	system_interrupt_set_priority(SYSTEM_INTERRUPT_MODULE_SERCOM2, IRQ_PRIORITY_SERCOM);
+	system_interrupt_set_priority(SYSTEM_INTERRUPT_MODULE_CAN0, IRQ_PRIORITY_CAN);
+
+	// Without the sampler SysTick isn't running. Let it run free, interrupt off, as the cycle counter
+	if(!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)) {
+		SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+		SysTick->VAL = 0;
+		SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+	}
+
+	for(int i = 0; i < IRQ_NUM_SOURCES; i++) {
+		s2c_irqstat_reset(&irq_stats[i]);
+	}
+}
+
+/**
+ * \brief Fills a debug frame payload with one source's statistics
+ *
+ * \param source	interrupt source to report
+ * \param data		8 byte payload
+ *
+ */
+void irq_report(enum irq_source source, uint8_t *data) {
+	struct s2c_irqstat stat = irq_stats[source];
+
+	uint32_t jitter = s2c_irqstat_has_latency(&stat) ? stat.max_latency - stat.min_latency : 0;
+
+	data[0] = source;
+	data[1] = (jitter > 0xFF) ? 0xFF : jitter;
+	convert_16_bit_to_byte_array(stat.max_latency > 0xFFFF ? 0xFFFF : stat.max_latency, data + 2);
+	convert_16_bit_to_byte_array(stat.max_duration > 0xFFFF ? 0xFFFF : stat.max_duration, data + 4);
+	convert_16_bit_to_byte_array(stat.count, data + 6);
+}
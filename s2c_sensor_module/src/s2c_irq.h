@@ -0,0 +1,88 @@
+/*
+ * s2c_irq.h
+ *
+ * Created: 2026-10-19 6:03:52 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_IRQ_H_
+#define S2C_IRQ_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Interrupt priority plan, highest first:
+ * --> timers (SysTick sampler pacing, any TC added later): a late tick is
+ *     sample time jitter, which smears the analysis FFT and the capture
+ * --> ADC: the callback must read the result before the next conversion
+ *     lands, and the window monitor triggers capture
+ * --> SERCOM (I2C): the master clocks the bus, so a late handler only
+ *     stretches the transfer
+ * --> CAN: the M_CAN sends and counts errors on its own, error handling can
+ *     wait a few hundred us
+ */
+#define IRQ_PRIORITY_TIMER		SYSTEM_INTERRUPT_PRIORITY_LEVEL_0
+#define IRQ_PRIORITY_ADC		SYSTEM_INTERRUPT_PRIORITY_LEVEL_1
+#define IRQ_PRIORITY_SERCOM		SYSTEM_INTERRUPT_PRIORITY_LEVEL_2
+#define IRQ_PRIORITY_CAN		SYSTEM_INTERRUPT_PRIORITY_LEVEL_3
+
+/*
+ * Instrumentation. SysTick is the cycle counter: it is either pacing the
+ * sampler or, without the sampler, left running free with its interrupt off.
+ * Handlers call irq_enter() first and irq_exit() / irq_exit_tick() last.
+ * Latency is only known for SysTick, which knows when it fired; the ADC,
+ * SERCOM and CAN handlers only record their duration. The SERCOM handlers
+ * are instrumented in the ASF sercom_interrupt.c.
+ * Durations of handlers longer than one SysTick period are undercounted.
+ *
+ * Debug frame (USE_IRQ_REPORT), one per source:
+ * byte 0: source, byte 1: latency jitter (max - min), bytes 2 & 3: max
+ * latency, bytes 4 & 5: max duration (cycles, saturated), bytes 6 & 7:
+ * handler runs (low 16 bits). Bytes 1 to 3 are 0 for ADC, CAN and SERCOM,
+ * which have no latency.
+ *
+ * The SysTick and ADC handlers set the sample timing, so their whole call
+ * graph is RAMFUNC: copied to SRAM at startup with .data and run there, so
+ * flash wait states, which change with the clock profile, don't add to their
+ * latency or jitter. That is the sampler and capture hooks, the ADC driver's
+ * handler and adc_read_buffer_job(), the scan, alarm and capture callbacks
+ * and everything they call; the rest is static inline from the ASF headers.
+ * Anything added to those paths must be RAMFUNC too, or the handler waits on
+ * flash again. The SERCOM and CAN handlers stay in flash, their timing
+ * doesn't matter (see the priority plan above).
+ * Compare these frames against a build without RAMFUNC to see the gain.
+ */
+
+enum irq_source {
+	IRQ_SOURCE_SYSTICK,
+	IRQ_SOURCE_ADC,
+	IRQ_SOURCE_CAN,
+	IRQ_SOURCE_SERCOM, // after CAN so the report's source numbers stay the same
+	IRQ_NUM_SOURCES
+};
+
+extern struct s2c_irqstat irq_stats[IRQ_NUM_SOURCES];
+
+void irq_init(void);
+void irq_report(enum irq_source source, uint8_t *data);
+
+static inline uint32_t irq_enter(void) {
+	return SysTick->VAL;
+}
+
+static inline void irq_exit(enum irq_source source, uint32_t entry) {
+	s2c_irqstat_record_duration(&irq_stats[source], s2c_irqstat_elapsed(entry, SysTick->VAL, SysTick->LOAD));
+}
+
+/*
+ * For the SysTick handler itself: the latency is the time since the counter hit 0
+ */
+static inline void irq_exit_tick(uint32_t entry) {
+	uint32_t reload = SysTick->LOAD;
+	s2c_irqstat_record(&irq_stats[IRQ_SOURCE_SYSTICK], s2c_irqstat_elapsed(0, entry, reload),
+			s2c_irqstat_elapsed(entry, SysTick->VAL, reload));
+}
+
+#endif /* S2C_IRQ_H_ */
@@ -0,0 +1,78 @@
+/*
+ * s2c_log.c
+ *
+ * Created: 2026-10-19 8:34:27 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_log.h>
+
+static struct log_record log_records[LOG_RING_SLOTS];
+static struct s2c_ring log_ring;
+static volatile uint16_t log_dropped = 0; // records lost to a full ring since the last drop report
+
+/**
+ * \brief Sets up the log ring. Records written before this are dropped
+ */
+void log_init(void) {
+	s2c_ring_init(&log_ring, log_records, sizeof(log_records[0]), LOG_RING_SLOTS);
+}
+
+/**
+ * \brief Queues one record, use S2C_LOG() instead
+ *
+ * Callable from the main loop and from any interrupt. Interrupts are masked
+ * for the few instructions it takes to fill the slot, since the ring only
+ * allows one producer at a time.
+ *
+ */
+void log_write(uint16_t id, uint16_t a, uint16_t b, uint16_t c) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	struct log_record *record = (log_ring.data != NULL) ? s2c_ring_write_slot(&log_ring) : NULL;
+	if(record != NULL) {
+		record->id = id;
+		record->args[0] = a;
+		record->args[1] = b;
+		record->args[2] = c;
+		s2c_ring_commit(&log_ring);
+	} else if(log_dropped < 0xFFFF) {
+		++log_dropped;
+	}
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Gets the next log payload
+ *
+ * \param data 8 byte payload buffer
+ *
+ * \return true if data was filled, false if there is nothing to send
+ *
+ */
+bool log_drain(uint8_t *data) {
+	struct log_record record;
+
+	if(s2c_ring_pop(&log_ring, &record)) {
+		// sent as is
+	} else if(log_dropped > 0) {
+		// Report drops once the backlog has gone, so they show up after the records that made it
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		record.id = LOG_ID_DROPPED;
+		record.args[0] = log_dropped;
+		record.args[1] = record.args[2] = 0;
+		log_dropped = 0;
+		__set_PRIMASK(primask);
+	} else {
+		return false;
+	}
+
+	convert_16_bit_to_byte_array(record.id, data);
+	for(int i = 0; i < 3; i++) {
+		convert_16_bit_to_byte_array(record.args[i], data + 2 + 2 * i);
+	}
+	return true;
+}
@@ -0,0 +1,49 @@
+/*
+ * s2c_log.h
+ *
+ * Created: 2026-10-19 8:34:27 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_LOG_H_
+#define S2C_LOG_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Deferred-format logging.
+ *
+ * S2C_LOG("fmt", a, b, c) takes a printf format and up to three 16-bit
+ * arguments, but nothing is formatted on the chip. The format string goes
+ * into the .s2c_log ELF section, which is not loaded onto the chip, and its
+ * offset in that section is the log ID. A record is just the ID and the raw
+ * arguments, written into a RAM ring in a few tens of cycles, so S2C_LOG is
+ * cheap enough for the race build and safe from interrupts.
+ *
+ * The main loop drains one record per loop onto CAN_MSG_LOG:
+ * bytes 0 & 1: log ID, bytes 2 to 7: arguments a, b, c.
+ * If the ring overflowed, a LOG_ID_DROPPED record with the number of dropped
+ * records in a follows. tools/s2c_log_decode.py rebuilds the messages from a
+ * CAN log and the ELF's string table.
+ */
+
+#define LOG_ID_DROPPED	0xFFFF
+
+struct log_record {
+	uint16_t id;
+	uint16_t args[3];
+};
+
+#define S2C_LOG(...)	_S2C_LOG(__VA_ARGS__, 0, 0, 0, 0)
+#define _S2C_LOG(fmt, a, b, c, ...) do { \
+		static const char _s2c_log_fmt[] __attribute__((section(".s2c_log"), used)) = fmt; \
+		log_write((uint16_t)(uint32_t)_s2c_log_fmt, (a), (b), (c)); \
+	} while(0)
+
+void log_init(void);
+void log_write(uint16_t id, uint16_t a, uint16_t b, uint16_t c);
+bool log_drain(uint8_t *data);
+
+#endif /* S2C_LOG_H_ */
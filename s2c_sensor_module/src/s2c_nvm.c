@@ -0,0 +1,258 @@
+/*
+ * s2c_nvm.c
+ *
+ * Created: 2026-10-19 10:24:50 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_nvm.h>
+#include <s2c_log.h>
+#include <string.h>
+
+#define NVM_RWWEE_ADDR		0x00400000UL
+#define NVM_PAGES_PER_ROW	4
+#define NVM_NUM_PAGES		(RWW_SIZE / FLASH_PAGE_SIZE)
+#define NVM_NO_PAGE			0xFFFF
+#define NVM_CRC_LENGTH		offsetof(struct nvm_record, crc)
+
+_Static_assert(sizeof(struct nvm_record) <= FLASH_PAGE_SIZE, "NVM record doesn't fit a page");
+
+struct nvm_record nvm_active;
+static struct nvm_record nvm_pending; // edited over CAN, written by NVM_CMD_SAVE
+static uint16_t newest_page = NVM_NO_PAGE;
+
+static const struct nvm_record *nvm_page(uint16_t page) {
+	return (const struct nvm_record *)(NVM_RWWEE_ADDR + (uint32_t)page * FLASH_PAGE_SIZE);
+}
+
+static bool nvm_valid(const struct nvm_record *record) {
+	return s2c_crc16((const uint8_t *)record, NVM_CRC_LENGTH) == record->crc;
+}
+
+/*
+ * Checks a value against its field's limits, NVM_UNSET always passes
+ */
+static bool nvm_in_limits(uint8_t field, uint16_t value) {
+	if(value == NVM_UNSET) return true;
+
+	switch(field) {
+	case NVM_FIELD_BOARD_ID:
+		return value <= NVM_BOARD_ID_MAX;
+	case NVM_FIELD_LOOP_PERIOD_MS:
+		return value >= NVM_LOOP_PERIOD_MS_MIN && value <= NVM_LOOP_PERIOD_MS_MAX;
+	case NVM_FIELD_ADC_GAIN_CORR:
+	case NVM_FIELD_ADC_OFFSET_CORR:
+		return value <= 0xFFF;
+	default:
+		return true;
+	}
+}
+
+static void nvm_blank(struct nvm_record *record) {
+	record->magic = NVM_RECORD_MAGIC;
+	record->version = NVM_RECORD_VERSION;
+	record->reserved = 0;
+	record->sequence = 0;
+	for(int i = 0; i < NVM_NUM_FIELDS; i++) {
+		record->fields[i] = NVM_UNSET;
+	}
+}
+
+/**
+ * \brief Runs one NVMCTRL command and waits for it
+ *
+ * \return true if the command finished without an error
+ *
+ */
+static bool nvm_run(uint32_t command, uint32_t address) {
+	while(!(NVMCTRL->INTFLAG.reg & NVMCTRL_INTFLAG_READY));
+	NVMCTRL->STATUS.reg = NVMCTRL_STATUS_MASK;
+	NVMCTRL->ADDR.reg = address / 2; // 16-bit word address
+	NVMCTRL->CTRLA.reg = command | NVMCTRL_CTRLA_CMDEX_KEY;
+	while(!(NVMCTRL->INTFLAG.reg & NVMCTRL_INTFLAG_READY));
+	return !(NVMCTRL->STATUS.reg & (NVMCTRL_STATUS_NVME | NVMCTRL_STATUS_LOCKE | NVMCTRL_STATUS_PROGE));
+}
+
+static bool nvm_page_erased(uint16_t page) {
+	const uint32_t *words = (const uint32_t *)nvm_page(page);
+	for(int i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+		if(words[i] != 0xFFFFFFFF) return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Writes a record into the next page of the log
+ *
+ * \return true if the record reads back intact
+ *
+ */
+static bool nvm_write(const struct nvm_record *record) {
+	uint16_t page = (newest_page == NVM_NO_PAGE) ? 0 : (newest_page + 1) % NVM_NUM_PAGES;
+	// A torn write can leave garbage past the newest record: skip to a fresh row
+	if(page % NVM_PAGES_PER_ROW != 0 && !nvm_page_erased(page)) {
+		page = (page / NVM_PAGES_PER_ROW + 1) * NVM_PAGES_PER_ROW % NVM_NUM_PAGES;
+	}
+	uint32_t address = (uint32_t)nvm_page(page);
+	if(page % NVM_PAGES_PER_ROW == 0 && !nvm_run(NVMCTRL_CTRLA_CMD_RWWEEER, address)) {
+		return false;
+	}
+
+	// Fill the page buffer with whole words, then write it
+	union {
+		struct nvm_record record;
+		uint32_t words[FLASH_PAGE_SIZE / 4];
+	} buffer;
+	memset(&buffer, 0xFF, sizeof(buffer));
+	buffer.record = *record;
+
+	NVMCTRL->CTRLB.bit.MANW = 1;
+	if(!nvm_run(NVMCTRL_CTRLA_CMD_PBC, address)) return false;
+	volatile uint32_t *dst = (volatile uint32_t *)address;
+	for(int i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+		dst[i] = buffer.words[i];
+	}
+	if(!nvm_run(NVMCTRL_CTRLA_CMD_RWWEEWP, address)) return false;
+
+	if(memcmp(nvm_page(page), record, sizeof(*record)) != 0) return false;
+	newest_page = page;
+	return true;
+}
+
+/**
+ * \brief Loads the newest valid record into nvm_active
+ *
+ * Call at boot, before anything reads the configuration.
+ *
+ */
+void nvm_init(void) {
+	uint32_t below = UINT32_MAX; // only consider sequences below this
+
+	nvm_blank(&nvm_active);
+	while(1) {
+		// Newest candidate by header alone, then check just that one
+		uint16_t best = NVM_NO_PAGE;
+		for(uint16_t page = 0; page < NVM_NUM_PAGES; page++) {
+			const struct nvm_record *record = nvm_page(page);
+			if(record->magic != NVM_RECORD_MAGIC || record->version != NVM_RECORD_VERSION ||
+					record->sequence >= below) continue;
+			if(best == NVM_NO_PAGE || record->sequence > nvm_page(best)->sequence) best = page;
+		}
+		if(best == NVM_NO_PAGE) break;
+
+		if(nvm_valid(nvm_page(best))) {
+			nvm_active = *nvm_page(best);
+			break;
+		}
+		S2C_LOG("nvm: bad CRC in page %u", best);
+		below = nvm_page(best)->sequence;
+	}
+
+	// Keep writing after the newest record of any version, so the log never goes back over it
+	for(uint16_t page = 0; page < NVM_NUM_PAGES; page++) {
+		const struct nvm_record *record = nvm_page(page);
+		if(record->magic != NVM_RECORD_MAGIC) continue;
+		if(newest_page == NVM_NO_PAGE || record->sequence > nvm_page(newest_page)->sequence) newest_page = page;
+	}
+
+	// A record from before the limits, or written by something else, falls back to the defaults field by field
+	for(int i = 0; i < NVM_NUM_FIELDS; i++) {
+		if(nvm_in_limits(i, nvm_active.fields[i])) continue;
+		S2C_LOG("nvm: field %u out of limits: %u", i, nvm_active.fields[i]);
+		nvm_active.fields[i] = NVM_UNSET;
+	}
+
+	nvm_pending = nvm_active;
+	S2C_LOG("nvm: record %u of version %u", (uint16_t)nvm_active.sequence, NVM_RECORD_VERSION);
+}
+
+/**
+ * \brief Gets a field of the active record, NVM_UNSET if it isn't configured
+ */
+uint16_t nvm_get(enum nvm_field field) {
+	return nvm_active.fields[field];
+}
+
+/**
+ * \brief Sets a field of the active record and of the one nvm_save() writes
+ *
+ * For values the firmware works out itself, which apply straight away.
+ *
+ */
+void nvm_set(enum nvm_field field, uint16_t value) {
+	nvm_active.fields[field] = value;
+	nvm_pending.fields[field] = value;
+}
+
+/**
+ * \brief Writes the pending record to the RWW EEPROM
+ *
+ * Blocks for the row erase and page write, a few ms.
+ *
+ * \return true if the record was written and reads back intact
+ *
+ */
+bool nvm_save(void) {
+	nvm_pending.magic = NVM_RECORD_MAGIC;
+	nvm_pending.version = NVM_RECORD_VERSION;
+	nvm_pending.sequence = (newest_page == NVM_NO_PAGE) ? 0 : nvm_page(newest_page)->sequence + 1;
+	nvm_pending.crc = s2c_crc16((const uint8_t *)&nvm_pending, NVM_CRC_LENGTH);
+	if(!nvm_write(&nvm_pending)) {
+		S2C_LOG("nvm: save %u failed", (uint16_t)nvm_pending.sequence);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Handles a command channel frame
+ *
+ * Runs in the main loop. A save blocks for a few ms, see nvm_save().
+ *
+ * \param command	8 byte command payload
+ * \param reply		8 byte reply payload, always filled
+ *
+ */
+void nvm_command(const uint8_t *command, uint8_t *reply) {
+	uint8_t field = command[1];
+	uint16_t value = command[2] | (command[3] << 8);
+	enum nvm_status status = NVM_STATUS_OK;
+
+	switch(command[0]) {
+	case NVM_CMD_GET:
+	case NVM_CMD_SET:
+		if(field >= NVM_NUM_FIELDS) {
+			status = NVM_STATUS_BAD_FIELD;
+			break;
+		}
+		if(command[0] == NVM_CMD_SET) {
+			if(nvm_in_limits(field, value)) {
+				nvm_pending.fields[field] = value;
+			} else {
+				status = NVM_STATUS_BAD_VALUE;
+			}
+		}
+		value = nvm_pending.fields[field];
+		break;
+
+	case NVM_CMD_SAVE:
+		if(!nvm_save()) status = NVM_STATUS_WRITE_FAILED;
+		break;
+
+	case NVM_CMD_DEFAULTS:
+		nvm_blank(&nvm_pending);
+		break;
+
+	case NVM_CMD_RESET:
+		NVIC_SystemReset();
+		break;
+
+	default:
+		status = NVM_STATUS_BAD_COMMAND;
+	}
+
+	reply[0] = command[0];
+	reply[1] = field;
+	convert_16_bit_to_byte_array(value, reply + 2);
+	reply[4] = status;
+}
@@ -0,0 +1,89 @@
+/*
+ * s2c_nvm.h
+ *
+ * Created: 2026-10-19 10:24:50 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_NVM_H_
+#define S2C_NVM_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Persistent configuration and calibration.
+ *
+ * The record lives in the 8 kB RWW EEPROM, one record per 64 byte page,
+ * written as a log: every save goes into the page after the newest record,
+ * and a row (4 pages) is erased when the log moves into it. Each row is then
+ * erased once every 128 saves. The newest record (highest sequence) with this
+ * firmware's version and a good CRC wins. At boot only the newest record's
+ * CRC is checked, unless it is bad. The RWW EEPROM is written while the code
+ * keeps running from the main flash.
+ *
+ * Fields left at NVM_UNSET (erased flash) keep the firmware's defaults, so a
+ * blank module behaves exactly like before. Changes take effect after a reset.
+ * A SET outside the field's limits (NVM_BOARD_ID_MAX, NVM_LOOP_PERIOD_MS_MIN
+ * and _MAX, 12 bits for the ADC corrections) is refused with
+ * NVM_STATUS_BAD_VALUE, and a loaded field outside them is dropped back to
+ * NVM_UNSET, so a bad record can't take the module off the bus.
+ *
+ * Command channel: CAN_MSG_COMMAND to the module, CAN_MSG_COMMAND_REPLY back.
+ * byte 0: command, byte 1: field, bytes 2 & 3: value. The reply repeats
+ * them, with the field's value for a get, and adds byte 4: status.
+ */
+
+#define NVM_RECORD_MAGIC	0x5332 // "S2"
+#define NVM_RECORD_VERSION	1
+#define NVM_UNSET			0xFFFF
+#define NVM_BOARD_ID_MAX		15 // CAN_MSG_ID() has 4 bits for it
+#define NVM_LOOP_PERIOD_MS_MIN	1
+#define NVM_LOOP_PERIOD_MS_MAX	1000
+
+enum nvm_command {
+	NVM_CMD_GET = 1,		// read a field of the pending record
+	NVM_CMD_SET,			// change a field of the pending record
+	NVM_CMD_SAVE,			// write the pending record to the RWW EEPROM
+	NVM_CMD_DEFAULTS,		// set every field of the pending record to NVM_UNSET
+	NVM_CMD_RESET			// reset the module to apply the saved record
+};
+
+enum nvm_field {
+	NVM_FIELD_BOARD_ID,			// replaces the pinstrap ID
+	NVM_FIELD_LOOP_PERIOD_MS,	// main loop period when the adaptive rate is off
+	NVM_FIELD_COV_HEARTBEAT_MS,
+	NVM_FIELD_COV_DEADBAND,		// one per frame 1 signal
+	NVM_FIELD_ADC_GAIN_CORR = NVM_FIELD_COV_DEADBAND + COV_MAX_SIGNALS, // ADC GAINCORR, 2048 is 1.0
+	NVM_FIELD_ADC_OFFSET_CORR,	// ADC OFFSETCORR, 12-bit two's complement
+	NVM_NUM_FIELDS
+};
+
+enum nvm_status {
+	NVM_STATUS_OK,
+	NVM_STATUS_BAD_COMMAND,
+	NVM_STATUS_BAD_FIELD,
+	NVM_STATUS_WRITE_FAILED,
+	NVM_STATUS_BAD_VALUE		// outside the field's limits, not set
+};
+
+struct nvm_record {
+	uint16_t magic;
+	uint8_t version;
+	uint8_t reserved;
+	uint32_t sequence;			// saves so far, the newest record wins
+	uint16_t fields[NVM_NUM_FIELDS];
+	uint16_t crc;				// over everything before it
+};
+
+// Record in use since boot. All fields NVM_UNSET if there was none
+extern struct nvm_record nvm_active;
+
+void nvm_init(void);
+uint16_t nvm_get(enum nvm_field field);
+void nvm_set(enum nvm_field field, uint16_t value);
+bool nvm_save(void);
+void nvm_command(const uint8_t *command, uint8_t *reply);
+
+#endif /* S2C_NVM_H_ */
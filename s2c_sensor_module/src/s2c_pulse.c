@@ -0,0 +1,200 @@
+/*
+ * s2c_pulse.c
+ *
+ * Created: 2026-10-19 11:47:03 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_pulse.h>
+
+#define PULSE_FREQM_GCLK_ID_REF	4 // GCLK_FREQM_REF, missing from the device header
+
+// Hardware behind each period input
+struct pulse_period_hw {
+	Tc *tc;				// first of the 32-bit pair
+	uint32_t apbc_mask;	// both TCs of the pair
+	uint8_t gclk_id;
+	uint8_t evsys_user;
+	uint8_t extint;
+	uint32_t pin;
+	uint32_t mux;
+};
+
+static const struct pulse_period_hw period_hw[PULSE_NUM_PERIOD_INPUTS] = {
+	{ TC0, MCLK_APBCMASK_TC0 | MCLK_APBCMASK_TC1, TC0_GCLK_ID, EVSYS_ID_USER_TC0_EVU, PULSE_0_EXTINT, PULSE_0_PIN, PULSE_0_MUX },
+	{ TC2, MCLK_APBCMASK_TC2 | MCLK_APBCMASK_TC3, TC2_GCLK_ID, EVSYS_ID_USER_TC2_EVU, PULSE_1_EXTINT, PULSE_1_PIN, PULSE_1_MUX }
+};
+
+static uint8_t pulse_mask = 0;
+static uint32_t last_period[PULSE_NUM_PERIOD_INPUTS]; // 0 until the second edge, and again once stopped
+static bool edge_seen[PULSE_NUM_PERIOD_INPUTS]; // false until the first edge, and again once stopped
+static uint32_t last_count = 0; // FREQM count of the last gate
+
+static void pulse_enable_gclk(uint8_t channel, enum gclk_generator generator) {
+	struct system_gclk_chan_config gclk_conf;
+	system_gclk_chan_get_config_defaults(&gclk_conf);
+	gclk_conf.source_generator = generator;
+	system_gclk_chan_set_config(channel, &gclk_conf);
+	system_gclk_chan_enable(channel);
+}
+
+static void pulse_set_pin(uint32_t pin, uint32_t mux) {
+	struct system_pinmux_config pin_conf;
+	system_pinmux_get_config_defaults(&pin_conf);
+	pin_conf.mux_position = mux;
+	pin_conf.input_pull = SYSTEM_PINMUX_PIN_PULL_UP; // open collector sensors
+	system_pinmux_pin_set_config(pin, &pin_conf);
+}
+
+static void pulse_set_gclk_gen(enum gclk_generator generator, enum system_clock_source source, uint32_t division) {
+	struct system_gclk_gen_config gen_conf;
+	system_gclk_gen_get_config_defaults(&gen_conf);
+	gen_conf.source_clock = source;
+	gen_conf.division_factor = division;
+	system_gclk_gen_set_config(generator, &gen_conf);
+	system_gclk_gen_enable(generator);
+}
+
+/**
+ * \brief Sets up one EIC -> EVSYS -> TC period capture chain
+ *
+ * The EIC has to be disabled while this runs.
+ *
+ */
+static void pulse_init_period(uint8_t input) {
+	const struct pulse_period_hw *hw = &period_hw[input];
+	Tc *tc = hw->tc;
+
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, hw->apbc_mask);
+	pulse_enable_gclk(hw->gclk_id, PULSE_GCLK_GENERATOR);
+	pulse_set_pin(hw->pin, hw->mux);
+
+	// EIC: rising edge, majority filter over 3 samples, event out, no interrupt
+	EIC->CONFIG[hw->extint / 8].reg |= (EIC_CONFIG_SENSE0_RISE_Val | EIC_CONFIG_FILTEN0) << (4 * (hw->extint % 8));
+	EIC->EVCTRL.reg |= EIC_EVCTRL_EXTINTEO(1 << hw->extint);
+
+	// One EVSYS channel per input, numbered like the inputs
+	EVSYS->CHANNEL[input].reg = EVSYS_CHANNEL_EVGEN(EVSYS_ID_GEN_EIC_EXTINT_0 + hw->extint) |
+		EVSYS_CHANNEL_PATH_ASYNCHRONOUS;
+	EVSYS->USER[hw->evsys_user].reg = EVSYS_USER_CHANNEL(input + 1);
+
+	// TC: 32 bits at 1 MHz, period into CC0 and restart on each event
+	tc->COUNT32.CTRLA.reg = TC_CTRLA_SWRST;
+	while(tc->COUNT32.SYNCBUSY.reg & TC_SYNCBUSY_SWRST);
+	tc->COUNT32.CTRLA.reg = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_PRESCALER_DIV1 | TC_CTRLA_CAPTEN0 | TC_CTRLA_CAPTEN1;
+	tc->COUNT32.EVCTRL.reg = TC_EVCTRL_TCEI | TC_EVCTRL_EVACT_PPW;
+	tc->COUNT32.CTRLA.reg |= TC_CTRLA_ENABLE;
+	while(tc->COUNT32.SYNCBUSY.reg & TC_SYNCBUSY_ENABLE);
+}
+
+/**
+ * \brief Clocks generator 4 from the pin and starts the first FREQM gate
+ */
+static void pulse_init_freqm(void) {
+	system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBA, MCLK_APBAMASK_FREQM);
+	pulse_set_pin(PULSE_2_PIN, PULSE_2_MUX);
+	pulse_set_gclk_gen(PULSE_2_GCLK_GENERATOR, SYSTEM_CLOCK_SOURCE_GCLKIN, 1);
+	pulse_set_gclk_gen(PULSE_FREQM_REF_GENERATOR, SYSTEM_CLOCK_SOURCE_ULP32K, 32768 / PULSE_FREQM_REF_HZ);
+	pulse_enable_gclk(FREQM_GCLK_ID_MSR, PULSE_2_GCLK_GENERATOR);
+	pulse_enable_gclk(PULSE_FREQM_GCLK_ID_REF, PULSE_FREQM_REF_GENERATOR);
+
+	FREQM->CFGA.reg = FREQM_CFGA_REFNUM(PULSE_FREQM_GATE_CYCLES);
+	FREQM->CTRLA.reg = FREQM_CTRLA_ENABLE;
+	while(FREQM->SYNCBUSY.reg & FREQM_SYNCBUSY_ENABLE);
+	FREQM->CTRLB.reg = FREQM_CTRLB_START;
+}
+
+/**
+ * \brief Sets up the pulse inputs a board uses
+ *
+ * \param mask	bit n set if input n is used
+ *
+ */
+void pulse_init(uint8_t mask) {
+	pulse_mask = mask;
+	if(mask == 0) return;
+
+	if(mask & ((1 << PULSE_NUM_PERIOD_INPUTS) - 1)) {
+		Assert(system_gclk_gen_get_hz(PULSE_GCLK_GENERATOR) == PULSE_CLOCK_HZ);
+		system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBA, MCLK_APBAMASK_EIC);
+		system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, MCLK_APBCMASK_EVSYS);
+		pulse_enable_gclk(EIC_GCLK_ID, PULSE_GCLK_GENERATOR); // for the filter
+
+		// EIC CONFIG and EVCTRL are enable-protected
+		EIC->CTRLA.reg = 0;
+		while(EIC->SYNCBUSY.reg);
+		for(uint8_t i = 0; i < PULSE_NUM_PERIOD_INPUTS; i++) {
+			if(mask & (1 << i)) pulse_init_period(i);
+		}
+		EIC->CTRLA.reg = EIC_CTRLA_ENABLE;
+		while(EIC->SYNCBUSY.reg);
+	}
+	if(mask & (1 << PULSE_NUM_PERIOD_INPUTS)) {
+		pulse_init_freqm();
+	}
+}
+
+/**
+ * \brief Gets a period input's current period
+ *
+ * Runs in the main loop: a register read or two, whatever the input frequency.
+ *
+ * \param input	period input, 0 or 1
+ *
+ * \return period in us, 0 if the input is stopped or not used
+ *
+ */
+uint32_t pulse_period_us(uint8_t input) {
+	if(input >= PULSE_NUM_PERIOD_INPUTS || !(pulse_mask & (1 << input))) return 0;
+	Tc *tc = period_hw[input].tc;
+
+	// The first edge after a start or a stop only ends a wait, not a period
+	if(tc->COUNT32.INTFLAG.reg & TC_INTFLAG_MC0) {
+		uint32_t period = tc->COUNT32.CC[0].reg; // clears MC0
+		tc->COUNT32.INTFLAG.reg = TC_INTFLAG_ERR;
+		if(edge_seen[input]) last_period[input] = period;
+		edge_seen[input] = true;
+	}
+
+	tc->COUNT32.CTRLBSET.reg = TC_CTRLBSET_CMD_READSYNC;
+	while(tc->COUNT32.CTRLBSET.reg & TC_CTRLBSET_CMD_Msk);
+	uint32_t since_edge = tc->COUNT32.COUNT.reg;
+
+	// COUNT wraps after ~71.6 minutes without an edge and looks recent again. The main loop
+	// sees the stop long before that, so forget the old period here
+	if(since_edge >= PULSE_STOPPED_US) {
+		last_period[input] = 0;
+		edge_seen[input] = false;
+		return 0;
+	}
+	if(last_period[input] == 0) return 0;
+	return (since_edge > last_period[input]) ? since_edge : last_period[input];
+}
+
+/**
+ * \brief Gets an input's frequency
+ *
+ * Runs in the main loop. Restarts the FREQM gate once it has closed.
+ *
+ * \param input	any input
+ *
+ * \return frequency in 0.1 Hz, 0 if the input is stopped or not used
+ *
+ */
+uint32_t pulse_frequency(uint8_t input) {
+	if(input < PULSE_NUM_PERIOD_INPUTS) {
+		uint32_t period_us = pulse_period_us(input);
+		return (period_us > 0) ? (10UL * PULSE_CLOCK_HZ + period_us / 2) / period_us : 0;
+	}
+	if(input >= PULSE_NUM_INPUTS || !(pulse_mask & (1 << input))) return 0;
+
+	if(FREQM->INTFLAG.reg & FREQM_INTFLAG_DONE) {
+		FREQM->INTFLAG.reg = FREQM_INTFLAG_DONE;
+		last_count = (FREQM->STATUS.reg & FREQM_STATUS_OVF) ? FREQM_VALUE_VALUE_Msk : (FREQM->VALUE.reg & FREQM_VALUE_VALUE_Msk);
+		FREQM->STATUS.reg = FREQM_STATUS_OVF;
+		FREQM->CTRLB.reg = FREQM_CTRLB_START;
+	}
+	// Cycles per gate to 0.1 Hz, saturating above ~1.7 MHz where 32 bits run out
+	if(last_count > UINT32_MAX / (10 * PULSE_FREQM_REF_HZ)) return UINT32_MAX;
+	return last_count * 10 * PULSE_FREQM_REF_HZ / PULSE_FREQM_GATE_CYCLES;
+}
@@ -0,0 +1,58 @@
+/*
+ * s2c_pulse.h
+ *
+ * Created: 2026-10-19 11:47:03 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_PULSE_H_
+#define S2C_PULSE_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Pulse and frequency inputs (wheel speed, flow meters, fan tachs, pump
+ * speed), measured in hardware. A board declares the ones it uses in
+ * s2c_board_config.pulse_mask. The CPU takes no interrupt per edge and only
+ * reads registers when the main loop asks, so its cost doesn't depend on the
+ * input frequency.
+ *
+ * Inputs 0 and 1 (PULSE_0/1_PIN, on the AN1 and AN2 pads) measure the period,
+ * which suits slow signals. Rising edges go through an EIC line, filtered,
+ * and an asynchronous EVSYS channel into a 32-bit TC pair (TC0/TC1, TC2/TC3)
+ * in pulse width capture mode. Each edge copies the counter into CC0 and
+ * restarts it, so CC0 holds the last period and COUNT the time since the last
+ * edge. The counters run at 1 MHz from GCLK generator 1, whatever the CPU
+ * clock profile. pulse_period_us() returns the longer of the two, so a
+ * stopping input reads as slowing down straight away, and as stopped (0)
+ * after PULSE_STOPPED_US without an edge. Once stopped, the old period is
+ * dropped and the input reads 0 until two new edges give a fresh one.
+ *
+ * Input 2 (PULSE_2_PIN, GCLK_IO4) counts edges, which suits fast signals. The
+ * pin clocks GCLK generator 4, and FREQM counts its cycles over a gate of
+ * PULSE_FREQM_GATE_CYCLES of a 1024 Hz reference (OSCULP32K / 32), ~249 ms,
+ * then the main loop restarts it. Resolution is about 4 Hz.
+ *
+ * pulse_frequency() gives any input in 0.1 Hz.
+ *
+ * Frame CAN_MSG_PULSE (any board with pulse inputs, every PULSE_FRAME_PERIOD_MS): 6 bytes
+ * --> bytes 0 & 1, 2 & 3, 4 & 5: inputs 0, 1, 2 in 0.1 Hz, saturating, 0 if not used
+ */
+
+#define PULSE_NUM_INPUTS			3
+#define PULSE_NUM_PERIOD_INPUTS		2 // the rest are FREQM
+#define PULSE_GCLK_GENERATOR		GCLK_GENERATOR_1
+#define PULSE_CLOCK_HZ				1000000UL
+#define PULSE_STOPPED_US			1000000UL
+#define PULSE_FREQM_REF_GENERATOR	GCLK_GENERATOR_2
+#define PULSE_FREQM_REF_HZ			1024
+#define PULSE_FREQM_GATE_CYCLES		255
+#define PULSE_FRAME_PERIOD_MS		100
+
+void pulse_init(uint8_t mask);
+uint32_t pulse_period_us(uint8_t input);
+uint32_t pulse_frequency(uint8_t input);
+
+#endif /* S2C_PULSE_H_ */
@@ -0,0 +1,118 @@
+/*
+ * s2c_sampler.c
+ *
+ * Created: 2026-10-19 10:03:17 AM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_sampler.h>
+#include <s2c_irq.h>
+
+static struct adc_module *sampler_adc = NULL;
+static sampler_hook_t sampler_hook = NULL;
+
+// Block ring. The SysTick handler produces whole blocks, the main loop consumes them
+static uint16_t sampler_blocks[SAMPLER_NUM_BLOCKS][SAMPLER_BLOCK_SIZE];
+static struct s2c_ring block_ring;
+static uint16_t *fill_block = NULL; // block being filled, NULL while the main loop holds all of them
+static uint16_t write_index = 0;
+
+static volatile uint16_t latest_sample = 0;
+static volatile uint32_t overruns = 0; // number of blocks dropped because the main loop fell behind
+
+/**
+ * \brief Starts sampling one ADC input at a fixed rate
+ *
+ * \param module	configured ADC instance, taken over by the sampler
+ * \param adc_input	ADC positive input to sample
+ * \param rate_hz	sample rate in Hz
+ *
+ */
+void sampler_init(struct adc_module *const module, uint32_t adc_input, uint32_t rate_hz) {
+	s2c_ring_init(&block_ring, sampler_blocks, sizeof(sampler_blocks[0]), SAMPLER_NUM_BLOCKS);
+	sampler_adc = module;
+	adc_set_positive_input(sampler_adc, adc_input);
+	adc_start_conversion(sampler_adc);
+
+	SysTick_Config(system_cpu_clock_get_hz() / rate_hz);
+}
+
+/**
+ * \brief Registers a function that is called with every new sample
+ *
+ * The hook runs inside the SysTick handler and must be short.
+ *
+ */
+void sampler_set_hook(sampler_hook_t hook) {
+	sampler_hook = hook;
+}
+
+/**
+ * \brief Gets the oldest full block of samples
+ *
+ * \return pointer to SAMPLER_BLOCK_SIZE samples, or NULL if no block is full yet
+ *
+ */
+uint16_t *sampler_get_block(void) {
+	return s2c_ring_read_slot(&block_ring);
+}
+
+/**
+ * \brief Hands the block returned by sampler_get_block() back to the sampler
+ */
+void sampler_release_block(void) {
+	s2c_ring_release(&block_ring);
+}
+
+/**
+ * \brief Gets the most recent sample
+ *
+ * \return raw ADC value
+ *
+ */
+uint16_t sampler_latest(void) {
+	return latest_sample;
+}
+
+/**
+ * \brief Gets the number of blocks that were dropped since boot
+ */
+uint32_t sampler_get_overruns(void) {
+	return overruns;
+}
+
+RAMFUNC void SysTick_Handler(void) {
+	uint32_t entry = irq_enter();
+	uint16_t result;
+
+	if(sampler_adc == NULL) return;
+
+	// Collect the conversion started on the previous tick and kick off the next one straight away
+	if(adc_read(sampler_adc, &result) != STATUS_OK) {
+		adc_start_conversion(sampler_adc);
+		irq_exit_tick(entry);
+		return;
+	}
+	adc_start_conversion(sampler_adc);
+
+	latest_sample = result;
+	if(sampler_hook != NULL) sampler_hook(result);
+
+	// Only start a block in a free slot. Without one the whole block is dropped
+	if(write_index == 0) {
+		fill_block = s2c_ring_write_slot(&block_ring);
+	}
+	if(fill_block != NULL) {
+		fill_block[write_index] = result;
+	}
+
+	if(++write_index >= SAMPLER_BLOCK_SIZE) {
+		write_index = 0;
+		if(fill_block != NULL) {
+			s2c_ring_commit(&block_ring);
+		} else {
+			++overruns;
+		}
+	}
+	irq_exit_tick(entry);
+}
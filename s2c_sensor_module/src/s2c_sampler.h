@@ -0,0 +1,38 @@
+/*
+ * s2c_sampler.h
+ *
+ * Created: 2026-10-19 10:03:17 AM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_SAMPLER_H_
+#define S2C_SAMPLER_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Fixed-rate sampler for a single ADC channel.
+ *
+ * SysTick paces the conversions: every tick the previous result is read and the
+ * next conversion is started, so the sample spacing doesn't depend on the main
+ * loop or on the ADC clock. Samples are stored in a lock-free ring (s2c_ring.h)
+ * of SAMPLER_BLOCK_SIZE blocks. The main loop takes full blocks with
+ * sampler_get_block() and hands them back with sampler_release_block(). If the
+ * main loop holds every block, new blocks are dropped and counted as overruns.
+ * An optional hook sees every sample as it arrives, in interrupt context.
+ *
+ * While the sampler runs it owns the ADC, so no buffer jobs may be started.
+ */
+
+typedef void (*sampler_hook_t)(uint16_t sample);
+
+void sampler_init(struct adc_module *const module, uint32_t adc_input, uint32_t rate_hz);
+void sampler_set_hook(sampler_hook_t hook);
+uint16_t *sampler_get_block(void);
+void sampler_release_block(void);
+uint16_t sampler_latest(void);
+uint32_t sampler_get_overruns(void);
+
+#endif /* S2C_SAMPLER_H_ */
@@ -0,0 +1,185 @@
+/*
+ * s2c_trace.c
+ *
+ * Created: 2026-10-19 7:21:14 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <s2c_trace.h>
+
+#define TRACE_RECORD_MAGIC	0x4D544221 // "MTB!"
+#define TRACE_NUM_PACKETS	(TRACE_BUFFER_BYTES / 8)
+
+struct trace_record {
+	uint32_t magic;
+	uint32_t cause;
+	uint32_t position;	// MTB POSITION when the trace was stopped
+	uint32_t master;	// MTB MASTER when the trace was stopped
+	uint32_t pc;		// stacked by the exception
+	uint32_t lr;
+};
+
+// Kept across resets in the .mtb section. The MTB needs the buffer aligned to its size
+#if USE_MTB_TRACE
+static uint32_t trace_buffer[TRACE_BUFFER_BYTES / 4] __attribute__((section(".mtb"), aligned(TRACE_BUFFER_BYTES)));
+#endif
+static struct trace_record trace_record __attribute__((section(".mtb")));
+
+// Dump of the previous run's trace. dump_index -1 means the header is next
+static enum trace_cause dump_cause = TRACE_CAUSE_NONE;
+static uint8_t dump_flags = 0;
+static uint16_t dump_count = 0;
+static uint16_t dump_first = 0; // buffer index of the oldest packet
+static int16_t dump_index = -1;
+
+void trace_hard_fault(const uint32_t *frame);
+void trace_watchdog(const uint32_t *frame);
+
+static void trace_start(void) {
+#if USE_MTB_TRACE
+	MTB->POSITION.reg = ((uint32_t)trace_buffer - MTB->BASE.reg) & MTB_POSITION_POINTER_Msk;
+	MTB->FLOW.reg = 0; // no watermark, the buffer wraps
+	// MASK sets the buffer size to 2^(MASK + 4) bytes
+	MTB->MASTER.reg = MTB_MASTER_EN | MTB_MASTER_MASK(31 - __builtin_clz(TRACE_BUFFER_BYTES) - 4);
+#endif
+}
+
+/**
+ * \brief Stops the trace and records why and where, for the next boot
+ *
+ * \param frame	exception stack frame (r0-r3, r12, lr, pc, xpsr)
+ * \param cause	what stopped it
+ *
+ */
+static void trace_save(const uint32_t *frame, enum trace_cause cause) {
+	uint32_t master = MTB->MASTER.reg;
+	MTB->MASTER.reg = master & ~MTB_MASTER_EN;
+
+	trace_record.cause = cause;
+	trace_record.position = MTB->POSITION.reg;
+	trace_record.master = master;
+	trace_record.lr = frame[5];
+	trace_record.pc = frame[6];
+	trace_record.magic = TRACE_RECORD_MAGIC;
+}
+
+/**
+ * \brief Picks up the previous run's trace, if any, or starts tracing
+ *
+ * Call first thing after system_init(). If there is a trace to dump, tracing
+ * only starts once trace_drain() has sent all of it.
+ *
+ */
+void trace_init(void) {
+	if(trace_record.magic == TRACE_RECORD_MAGIC) {
+		dump_cause = trace_record.cause;
+		if(trace_record.master & MTB_MASTER_EN) {
+			dump_flags = TRACE_FLAG_TRACING;
+			uint16_t next = (trace_record.position & MTB_POSITION_POINTER_Msk & (TRACE_BUFFER_BYTES - 1)) / 8;
+			if(trace_record.position & MTB_POSITION_WRAP) {
+				dump_count = TRACE_NUM_PACKETS;
+				dump_first = next;
+			} else {
+				dump_count = next;
+				dump_first = 0;
+			}
+		}
+	} else if(system_get_reset_cause() & SYSTEM_RESET_CAUSE_WDT) {
+		// Reset before the early warning could be handled: no position, no PC
+		dump_cause = TRACE_CAUSE_WATCHDOG;
+		dump_flags = TRACE_FLAG_ORDER_UNKNOWN;
+		trace_record.pc = 0;
+#if USE_MTB_TRACE
+		dump_flags |= TRACE_FLAG_TRACING;
+		dump_count = TRACE_NUM_PACKETS;
+#endif
+	}
+	trace_record.magic = 0;
+
+	if(dump_cause == TRACE_CAUSE_NONE) {
+		trace_start();
+	}
+}
+
+/**
+ * \brief Gets the next payload of the previous run's trace
+ *
+ * Runs in the main loop. Tracing restarts once the last packet has been handed out.
+ *
+ * \param data		8 byte payload buffer
+ * \param header	set to true if data is the header
+ *
+ * \return true if data was filled, false if there is nothing to send
+ *
+ */
+bool trace_drain(uint8_t *data, bool *header) {
+	if(dump_cause == TRACE_CAUSE_NONE) {
+		return false;
+	}
+
+	*header = dump_index < 0;
+	if(dump_index < 0) {
+		data[0] = dump_cause;
+		data[1] = dump_flags;
+		convert_16_bit_to_byte_array(dump_count, data + 2);
+		convert_16_bit_to_byte_array(trace_record.pc & 0xFFFF, data + 4);
+		convert_16_bit_to_byte_array(trace_record.pc >> 16, data + 6);
+		dump_index = 0;
+	} else {
+#if USE_MTB_TRACE
+		uint16_t packet = (dump_first + dump_index) % TRACE_NUM_PACKETS;
+		for(int i = 0; i < 2; i++) {
+			convert_16_bit_to_byte_array(trace_buffer[2 * packet + i] & 0xFFFF, data + 4 * i);
+			convert_16_bit_to_byte_array(trace_buffer[2 * packet + i] >> 16, data + 4 * i + 2);
+		}
+#endif
+		++dump_index;
+	}
+
+	if(dump_index >= dump_count) {
+		dump_cause = TRACE_CAUSE_NONE;
+		dump_index = -1;
+		trace_start();
+	}
+	return true;
+}
+
+/*
+ * The fault handlers find the exception stack frame (MSP or PSP, from bit 2 of
+ * EXC_RETURN) without touching the stack themselves, then hand it to C.
+ */
+__attribute__((naked)) void HardFault_Handler(void) {
+	__asm volatile(
+		"	movs r0, #4\n"
+		"	mov r1, lr\n"
+		"	tst r0, r1\n"
+		"	beq 1f\n"
+		"	mrs r0, psp\n"
+		"	bl trace_hard_fault\n"
+		"1:	mrs r0, msp\n"
+		"	bl trace_hard_fault\n");
+}
+
+__attribute__((naked)) void WDT_Handler(void) {
+	__asm volatile(
+		"	movs r0, #4\n"
+		"	mov r1, lr\n"
+		"	tst r0, r1\n"
+		"	beq 1f\n"
+		"	mrs r0, psp\n"
+		"	bl trace_watchdog\n"
+		"1:	mrs r0, msp\n"
+		"	bl trace_watchdog\n");
+}
+
+void trace_hard_fault(const uint32_t *frame) {
+	trace_save(frame, TRACE_CAUSE_HARD_FAULT);
+	NVIC_SystemReset();
+}
+
+void trace_watchdog(const uint32_t *frame) {
+	trace_save(frame, TRACE_CAUSE_WATCHDOG);
+	WDT->INTFLAG.reg = WDT_INTFLAG_EW;
+	// Wait for the watchdog reset, nothing else may run over the trace
+	while(1);
+}
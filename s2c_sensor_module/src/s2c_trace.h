@@ -0,0 +1,50 @@
+/*
+ * s2c_trace.h
+ *
+ * Created: 2026-10-19 7:21:14 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef S2C_TRACE_H_
+#define S2C_TRACE_H_
+
+#include <asf.h>
+#include <s2c_utils.h>
+
+/*
+ * Post-mortem execution trace.
+ *
+ * With USE_MTB_TRACE the Cortex-M0+ Micro Trace Buffer records every taken
+ * branch, exception entry and return into a TRACE_BUFFER_BYTES ring in the
+ * .mtb section (start of SRAM, not loaded or zeroed, so it survives resets).
+ * Each packet is 8 bytes: source address, destination address.
+ *
+ * The hard fault handler, and the watchdog early warning handler if the WDT
+ * is ever enabled with it, stop the trace and write a post-mortem record
+ * (cause, trace position, stacked PC and LR) next to the buffer. A hard fault
+ * then resets the chip. After the reset the trace stays stopped until
+ * trace_drain() has sent it, then tracing restarts. A watchdog reset without
+ * a record is dumped too, but the oldest packet isn't known then.
+ *
+ * Drained payloads (8 bytes each):
+ * - header (CAN_MSG_TRACE_HEADER): byte 0: cause, byte 1: flags,
+ *   bytes 2 & 3: number of packets, bytes 4 to 7: faulting PC
+ * - data (CAN_MSG_TRACE): bytes 0 to 3: source, bytes 4 to 7: destination,
+ *   oldest packet first
+ * tools/s2c_trace_decode.py turns a CAN log of the dump into source lines.
+ */
+
+enum trace_cause {
+	TRACE_CAUSE_NONE,
+	TRACE_CAUSE_HARD_FAULT,
+	TRACE_CAUSE_WATCHDOG
+};
+
+#define TRACE_FLAG_ORDER_UNKNOWN	0x01 // no record of the trace position, packets are in buffer order
+#define TRACE_FLAG_TRACING			0x02 // the trace was running when it stopped
+
+void trace_init(void);
+bool trace_drain(uint8_t *data, bool *header);
+
+#endif /* S2C_TRACE_H_ */
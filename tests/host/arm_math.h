@@ -0,0 +1,54 @@
+/*
+ * arm_math.h
+ *
+ * Created: 2026-10-20 2:10:05 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef HOST_ARM_MATH_H_
+#define HOST_ARM_MATH_H_
+
+/*
+ * Host stand-in for the CMSIS-DSP header, declaring only the functions the
+ * firmware's filter stage uses. arm_math_host.c implements them the way the
+ * Cortex-M0 library build does (its plain C path), so results match the chip
+ * bit for bit.
+ */
+
+#include <stdint.h>
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+typedef enum {
+	ARM_MATH_SUCCESS = 0,
+	ARM_MATH_ARGUMENT_ERROR = -1,
+	ARM_MATH_LENGTH_ERROR = -2
+} arm_status;
+
+typedef struct {
+	int8_t numStages;
+	q15_t *pState;
+	const q15_t *pCoeffs;
+	int8_t postShift;
+} arm_biquad_casd_df1_inst_q15;
+
+typedef struct {
+	uint8_t M;
+	uint16_t numTaps;
+	const q15_t *pCoeffs;
+	q15_t *pState;
+} arm_fir_decimate_instance_q15;
+
+void arm_biquad_cascade_df1_init_q15(arm_biquad_casd_df1_inst_q15 *S, uint8_t numStages,
+	const q15_t *pCoeffs, q15_t *pState, int8_t postShift);
+void arm_biquad_cascade_df1_q15(const arm_biquad_casd_df1_inst_q15 *S, const q15_t *pSrc, q15_t *pDst,
+	uint32_t blockSize);
+arm_status arm_fir_decimate_init_q15(arm_fir_decimate_instance_q15 *S, uint16_t numTaps, uint8_t M,
+	const q15_t *pCoeffs, q15_t *pState, uint32_t blockSize);
+void arm_fir_decimate_q15(const arm_fir_decimate_instance_q15 *S, const q15_t *pSrc, q15_t *pDst,
+	uint32_t blockSize);
+
+#endif /* HOST_ARM_MATH_H_ */
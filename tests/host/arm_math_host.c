@@ -0,0 +1,93 @@
+/*
+ * arm_math_host.c
+ *
+ * Created: 2026-10-20 2:10:05 PM
+ *  Author: Tal Zaitsev
+ */
+
+#include <string.h>
+#include <arm_math.h>
+
+/*
+ * The CMSIS-DSP Cortex-M0 (no SIMD) paths of the two q15 filters the
+ * firmware uses, for host builds of s2c_filter.c.
+ */
+
+static q15_t ssat16(q63_t value) {
+	return (value > INT16_MAX) ? INT16_MAX : (value < INT16_MIN) ? INT16_MIN : (q15_t)value;
+}
+
+void arm_biquad_cascade_df1_init_q15(arm_biquad_casd_df1_inst_q15 *S, uint8_t numStages,
+		const q15_t *pCoeffs, q15_t *pState, int8_t postShift) {
+	S->numStages = numStages;
+	S->pCoeffs = pCoeffs;
+	S->postShift = postShift;
+	memset(pState, 0, 4u * numStages * sizeof(q15_t));
+	S->pState = pState;
+}
+
+void arm_biquad_cascade_df1_q15(const arm_biquad_casd_df1_inst_q15 *S, const q15_t *pSrc, q15_t *pDst,
+		uint32_t blockSize) {
+	const q15_t *pIn = pSrc;
+	const q15_t *pCoeffs = S->pCoeffs;
+	q15_t *pState = S->pState;
+	int shift = 15 - S->postShift;
+
+	for(int stage = 0; stage < S->numStages; stage++) {
+		// Coefficients are {b0, 0, b1, b2, a1, a2}
+		q31_t b0 = pCoeffs[0], b1 = pCoeffs[2], b2 = pCoeffs[3], a1 = pCoeffs[4], a2 = pCoeffs[5];
+		q15_t Xn1 = pState[0], Xn2 = pState[1], Yn1 = pState[2], Yn2 = pState[3];
+
+		for(uint32_t n = 0; n < blockSize; n++) {
+			q15_t in = pIn[n];
+			q63_t acc = (q63_t)b0 * in + (q63_t)b1 * Xn1 + (q63_t)b2 * Xn2 + (q63_t)a1 * Yn1 + (q63_t)a2 * Yn2;
+			q15_t out = ssat16(acc >> shift);
+			Xn2 = Xn1;
+			Xn1 = in;
+			Yn2 = Yn1;
+			Yn1 = out;
+			pDst[n] = out;
+		}
+
+		pState[0] = Xn1;
+		pState[1] = Xn2;
+		pState[2] = Yn1;
+		pState[3] = Yn2;
+		pState += 4;
+		pCoeffs += 6;
+		pIn = pDst; // later stages filter in place
+	}
+}
+
+arm_status arm_fir_decimate_init_q15(arm_fir_decimate_instance_q15 *S, uint16_t numTaps, uint8_t M,
+		const q15_t *pCoeffs, q15_t *pState, uint32_t blockSize) {
+	if(blockSize % M != 0) return ARM_MATH_LENGTH_ERROR;
+	S->numTaps = numTaps;
+	S->pCoeffs = pCoeffs;
+	memset(pState, 0, (numTaps + blockSize - 1) * sizeof(q15_t));
+	S->pState = pState;
+	S->M = M;
+	return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_decimate_q15(const arm_fir_decimate_instance_q15 *S, const q15_t *pSrc, q15_t *pDst,
+		uint32_t blockSize) {
+	q15_t *pState = S->pState;
+	q15_t *pStateCurnt = S->pState + (S->numTaps - 1);
+
+	for(uint32_t out = 0; out < blockSize / S->M; out++) {
+		for(int i = 0; i < S->M; i++) {
+			*pStateCurnt++ = *pSrc++;
+		}
+		// Coefficients are stored time-reversed, oldest sample first
+		q63_t acc = 0;
+		for(int tap = 0; tap < S->numTaps; tap++) {
+			acc += (q31_t)pState[tap] * S->pCoeffs[tap];
+		}
+		pDst[out] = ssat16(acc >> 15);
+		pState += S->M;
+	}
+
+	// Keep the last numTaps - 1 inputs for the next block
+	memmove(S->pState, pState, (S->numTaps - 1) * sizeof(q15_t));
+}
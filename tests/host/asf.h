@@ -0,0 +1,33 @@
+/*
+ * asf.h
+ *
+ * Created: 2026-10-20 2:10:05 PM
+ *  Author: Tal Zaitsev
+ */
+
+
+#ifndef HOST_ASF_H_
+#define HOST_ASF_H_
+
+/*
+ * Host stand-in for the ASF umbrella header: just what the modules under
+ * test use, so they build unchanged with the host compiler.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#define Assert(expr)	assert(expr)
+#define UNUSED(v)		(void)(v)
+#define RAMFUNC
+
+static inline void convert_16_bit_to_byte_array(uint16_t value, uint8_t *data)
+{
+	data[0] = value & 0xFF;
+	data[1] = (value >> 8) & 0xFF;
+}
+
+#endif /* HOST_ASF_H_ */
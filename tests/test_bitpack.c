@@ -0,0 +1,171 @@
+/*
+ * test_bitpack.c
+ *
+ * Created: 2026-10-21 10:26:41 AM
+ *  Author: Tal Zaitsev
+ */
+
+/*
+ * Host test of the bit-packed CAN payloads (s2c_common/s2c_bitpack.h).
+ *
+ * Round-trips values through s2c_bitpack_encode() and s2c_bitpack_decode()
+ * for every frame 1 layout, and checks the encoded bits one by one against
+ * the little endian numbering in the header: signal bit i is payload bit
+ * offset + i, and payload bit n is bit n % 8 of byte n / 8. Most signals
+ * cross a byte boundary, and the tire temp and radiator ones cross two.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <s2c_bitpack.h>
+
+#define MAX_SIGNALS		3
+#define RANDOM_ROUNDS	1000
+
+struct layout {
+	const char *name;
+	struct s2c_bitpack_signal signals[MAX_SIGNALS];
+	uint8_t num_signals;
+	uint8_t length;
+};
+
+static const struct layout layouts[] = {
+	{ "wheel", S2C_WHEEL_FRAME_LAYOUT, 3, 5 },
+	{ "tire temp", S2C_TIRE_TEMP_FRAME_LAYOUT, 3, 6 },
+	{ "radiator", S2C_RADIATOR_FRAME_LAYOUT, 2, 4 },
+};
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+		if(!(cond)) { \
+			printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+			++failures; \
+		} \
+	} while(0)
+
+static uint16_t max_value(struct s2c_bitpack_signal signal) {
+	return (1UL << signal.width) - 1;
+}
+
+static bool payload_bit(const uint8_t *buf, unsigned n) {
+	return (buf[n / 8] >> (n % 8)) & 1;
+}
+
+/*
+ * Encodes vals, checks every payload bit against the numbering in the header,
+ * then decodes and compares with the saturated inputs
+ */
+static void round_trip(const struct layout *l, const uint16_t *vals, const char *what) {
+	uint8_t buf[8];
+	memset(buf, 0xA5, sizeof(buf));
+	uint8_t len = s2c_bitpack_encode(buf, l->signals, vals, l->num_signals);
+	CHECK(len == l->length, "%s %s: length %u, expected %u", l->name, what, len, l->length);
+	CHECK(buf[len] == 0xA5, "%s %s: wrote past the payload", l->name, what);
+
+	bool used[64] = { false };
+	for(int s = 0; s < l->num_signals; s++) {
+		struct s2c_bitpack_signal signal = l->signals[s];
+		uint16_t expected = (vals[s] > max_value(signal)) ? max_value(signal) : vals[s];
+		for(int i = 0; i < signal.width; i++) {
+			used[signal.offset + i] = true;
+			if(payload_bit(buf, signal.offset + i) != ((expected >> i) & 1)) {
+				CHECK(false, "%s %s: signal %d bit %d at payload bit %d", l->name, what, s, i, signal.offset + i);
+				break;
+			}
+		}
+	}
+	for(int n = 0; n < 8 * len; n++) {
+		if(!used[n] && payload_bit(buf, n)) {
+			CHECK(false, "%s %s: unused payload bit %d is set", l->name, what, n);
+			break;
+		}
+	}
+
+	uint16_t decoded[MAX_SIGNALS];
+	s2c_bitpack_decode(buf, l->signals, decoded, l->num_signals);
+	for(int s = 0; s < l->num_signals; s++) {
+		uint16_t expected = (vals[s] > max_value(l->signals[s])) ? max_value(l->signals[s]) : vals[s];
+		CHECK(decoded[s] == expected, "%s %s: signal %d decoded %u, expected %u", l->name, what, s, decoded[s], expected);
+	}
+}
+
+static void test_layout(const struct layout *l) {
+	uint16_t vals[MAX_SIGNALS];
+
+	for(int s = 0; s < l->num_signals; s++) vals[s] = 0;
+	round_trip(l, vals, "zeros");
+	for(int s = 0; s < l->num_signals; s++) vals[s] = max_value(l->signals[s]);
+	round_trip(l, vals, "full scale");
+
+	// Alternating bits show a signal shifted by one or bits swapped across a byte boundary
+	for(int s = 0; s < l->num_signals; s++) vals[s] = 0x5555 & max_value(l->signals[s]);
+	round_trip(l, vals, "0x5555");
+	for(int s = 0; s < l->num_signals; s++) vals[s] = 0xAAAA & max_value(l->signals[s]);
+	round_trip(l, vals, "0xAAAA");
+
+	// One signal at full scale between zeros doesn't leak into its neighbours
+	for(int only = 0; only < l->num_signals; only++) {
+		for(int s = 0; s < l->num_signals; s++) vals[s] = (s == only) ? max_value(l->signals[s]) : 0;
+		round_trip(l, vals, "one signal set");
+	}
+
+	// Saturation: anything above a signal's range is sent as its maximum
+	for(int s = 0; s < l->num_signals; s++) vals[s] = max_value(l->signals[s]) + 1;
+	round_trip(l, vals, "just over range");
+	for(int s = 0; s < l->num_signals; s++) vals[s] = 0xFFFF;
+	round_trip(l, vals, "0xFFFF");
+
+	uint32_t seed = 12345;
+	for(int round = 0; round < RANDOM_ROUNDS; round++) {
+		for(int s = 0; s < l->num_signals; s++) {
+			seed = seed * 1103515245 + 12345;
+			vals[s] = seed >> 16;
+		}
+		round_trip(l, vals, "random");
+	}
+}
+
+/*
+ * s2c_bitpack_put() only touches the signal's own bits
+ */
+static void test_put_keeps_neighbours(void) {
+	struct s2c_bitpack_signal signal = { 15, 15 };
+	uint8_t buf[6];
+	memset(buf, 0xFF, sizeof(buf));
+	s2c_bitpack_put(buf, signal, 0);
+
+	const uint8_t expected[6] = { 0xFF, 0x7F, 0x00, 0xC0, 0xFF, 0xFF };
+	CHECK(memcmp(buf, expected, sizeof(buf)) == 0, "put 0 at bits 15 to 29: %02X %02X %02X %02X %02X %02X",
+		buf[0], buf[1], buf[2], buf[3], buf[4], buf[5]);
+	CHECK(s2c_bitpack_get(buf, signal) == 0, "get after put 0");
+}
+
+/*
+ * A known wheel frame, byte for byte
+ */
+static void test_wheel_bytes(void) {
+	const struct s2c_bitpack_signal layout[] = S2C_WHEEL_FRAME_LAYOUT;
+	const uint16_t vals[] = { 0x3FF, 0xABC, 0x123 };
+	uint8_t buf[8];
+	uint8_t len = s2c_bitpack_encode(buf, layout, vals, 3);
+
+	const uint8_t expected[5] = { 0xFF, 0xF3, 0xEA, 0x48, 0x00 };
+	CHECK(len == 5 && memcmp(buf, expected, sizeof(expected)) == 0, "wheel frame: %02X %02X %02X %02X %02X",
+		buf[0], buf[1], buf[2], buf[3], buf[4]);
+}
+
+int main(void) {
+	for(unsigned i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++) {
+		test_layout(&layouts[i]);
+	}
+	test_put_keeps_neighbours();
+	test_wheel_bytes();
+
+	printf("%s: %d failure(s)\n", __FILE__, failures);
+	return failures ? 1 : 0;
+}
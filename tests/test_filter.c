@@ -0,0 +1,173 @@
+/*
+ * test_filter.c
+ *
+ * Created: 2026-10-20 2:10:05 PM
+ *  Author: Tal Zaitsev
+ */
+
+/*
+ * Host test of the filtering stage (s2c_sensor_module/src/s2c_filter.c)
+ * against the response promised in s2c_filter.h: DC and passband gain,
+ * stopband attenuation at and above the decimated Nyquist, and the step
+ * response. Test signals go through filter_process() in sampler blocks and
+ * come back through filter_drain(), so the payload layout and the state
+ * carried from block to block are covered too.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../s2c_sensor_module/src/s2c_filter.c" // for FILTER_BLOCK_OUTPUTS
+
+#define TEST_BLOCKS			8
+#define TEST_SAMPLES		(TEST_BLOCKS * SAMPLER_BLOCK_SIZE)
+#define TEST_OUTPUTS		(TEST_BLOCKS * FILTER_BLOCK_OUTPUTS)
+#define MEASURE_FROM		FILTER_BLOCK_OUTPUTS // amplitudes are measured once the filters have settled
+#define MID					512
+#define AMPLITUDE			400
+
+#define PASSBAND_DB			0.5
+#define STOPBAND_DB			24.0
+#define STEP_TOLERANCE		0.01
+#define STEP_OVERSHOOT		0.05
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+		if(!(cond)) { \
+			printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+			++failures; \
+		} \
+	} while(0)
+
+static uint16_t input[TEST_SAMPLES];
+static uint16_t output[TEST_OUTPUTS];
+
+// Runs input through a fresh filter and rebuilds the decimated stream from the payloads
+static void run(void) {
+	filter_init();
+	uint16_t expected_number = 0;
+	for(int b = 0; b < TEST_BLOCKS; b++) {
+		filter_process(input + b * SAMPLER_BLOCK_SIZE);
+
+		uint8_t data[8];
+		uint8_t length;
+		while((length = filter_drain(data)) > 0) {
+			uint16_t number = data[0] | data[1] << 8;
+			CHECK(number == expected_number, "block %d: payload starts at sample %u, expected %u", b, number, expected_number);
+			CHECK(length <= 8 && length % 2 == 0, "block %d: payload length %u", b, length);
+			for(int i = 2; i < length && number < TEST_OUTPUTS; i += 2) {
+				output[number++] = data[i] | data[i + 1] << 8;
+			}
+			expected_number = number;
+		}
+		CHECK(expected_number == (b + 1) * FILTER_BLOCK_OUTPUTS, "block %d: drained up to sample %u", b, expected_number);
+	}
+}
+
+static void make_sine(double f, double phase) {
+	for(int n = 0; n < TEST_SAMPLES; n++) {
+		input[n] = MID + lround(AMPLITUDE * sin(2 * M_PI * f * n + phase));
+	}
+}
+
+// Largest deviation from MID of the settled output, in dB relative to AMPLITUDE
+static double gain_db(void) {
+	int peak = 0;
+	for(int k = MEASURE_FROM; k < TEST_OUTPUTS; k++) {
+		int deviation = abs((int)output[k] - MID);
+		if(deviation > peak) peak = deviation;
+	}
+	return 20 * log10((peak > 0 ? peak : 0.5) / (double)AMPLITUDE);
+}
+
+int main(void) {
+	// A constant input passes through unchanged, at both ends of the range
+	const uint16_t levels[] = { 0, 1, 512, 1023 };
+	for(unsigned l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+		for(int n = 0; n < TEST_SAMPLES; n++) input[n] = levels[l];
+		run();
+		for(int k = 0; k < TEST_OUTPUTS; k++) {
+			if(abs((int)output[k] - levels[l]) > 1) {
+				CHECK(false, "constant %u: output %d is %u", levels[l], k, output[k]);
+				break;
+			}
+		}
+	}
+
+	// Passband
+	const double passband[] = { 0.005, 0.01, 0.02 };
+	for(unsigned i = 0; i < sizeof(passband) / sizeof(passband[0]); i++) {
+		make_sine(passband[i], 0);
+		run();
+		double gain = gain_db();
+		printf("sine %.4f fs %8.2f dB\n", passband[i], gain);
+		CHECK(fabs(gain) <= PASSBAND_DB, "passband %.4f fs: %.2f dB", passband[i], gain);
+	}
+
+	// Stopband, from the decimated Nyquist up. Decimated samples of a tone near their
+	// Nyquist can all miss its peaks, so the worst of several phases counts
+	const double stopband[] = { 1.0 / (2 * ADC_FILTER_DECIMATION), 0.15, 0.1875, 0.25, 0.375, 0.5 };
+	for(unsigned i = 0; i < sizeof(stopband) / sizeof(stopband[0]); i++) {
+		double worst = -INFINITY;
+		for(int p = 0; p < 4; p++) {
+			make_sine(stopband[i], M_PI / 4 * p + M_PI / 2);
+			run();
+			double gain = gain_db();
+			if(gain > worst) worst = gain;
+		}
+		printf("sine %.4f fs %8.2f dB\n", stopband[i], worst);
+		CHECK(worst <= -STOPBAND_DB, "stopband %.4f fs: %.2f dB", stopband[i], worst);
+	}
+
+	// Step 200 -> 800 inside the second block. The first decimated output to see it
+	// is the one whose newest input is the step
+	const int step_at = SAMPLER_BLOCK_SIZE + 100;
+	const int first_out = step_at / ADC_FILTER_DECIMATION;
+	for(int n = 0; n < TEST_SAMPLES; n++) input[n] = (n < step_at) ? 200 : 800;
+	run();
+	int settled = -1;
+	uint16_t peak = 0;
+	for(int k = 0; k < TEST_OUTPUTS; k++) {
+		if(k < first_out) {
+			CHECK(output[k] == 200, "step: output %d moved to %u before the step", k, output[k]);
+			continue;
+		}
+		if(output[k] > peak) peak = output[k];
+		if(fabs(output[k] - 800.0) > STEP_TOLERANCE * 600) settled = -1;
+		else if(settled < 0) settled = k - first_out;
+	}
+	printf("step settled after %d outputs, peak %u\n", settled, peak);
+	CHECK(settled >= 0 && settled <= FILTER_SETTLE_OUTPUTS, "step: settled after %d outputs", settled);
+	CHECK(peak <= 800 + STEP_OVERSHOOT * 600, "step: overshoot to %u", peak);
+
+	// Carried state: delaying the input by one filter call delays the output by exactly
+	// its outputs, although the block boundaries now fall elsewhere in the signal
+	static uint16_t reference[TEST_OUTPUTS];
+	make_sine(0.03, 0);
+	run();
+	memcpy(reference, output, sizeof(reference));
+	memmove(input + ADC_FILTER_BLOCK_SIZE, input, (TEST_SAMPLES - ADC_FILTER_BLOCK_SIZE) * sizeof(input[0]));
+	for(int n = 0; n < ADC_FILTER_BLOCK_SIZE; n++) input[n] = MID;
+	run();
+	for(int k = FILTER_CHUNK_OUTPUTS; k < TEST_OUTPUTS; k++) {
+		if(output[k] != reference[k - FILTER_CHUNK_OUTPUTS]) {
+			CHECK(false, "delayed sine: output %d is %u, %u undelayed", k, output[k], reference[k - FILTER_CHUNK_OUTPUTS]);
+			break;
+		}
+	}
+
+	// A block that isn't drained in time is replaced, and the sample numbers jump
+	for(int n = 0; n < TEST_SAMPLES; n++) input[n] = MID;
+	filter_init();
+	filter_process(input);
+	filter_process(input + SAMPLER_BLOCK_SIZE);
+	uint8_t data[8];
+	CHECK(filter_drain(data) == 2 + 2 * FILTER_SAMPLES_PER_FRAME, "replaced block: short first payload");
+	CHECK((data[0] | data[1] << 8) == FILTER_BLOCK_OUTPUTS, "replaced block: starts at sample %u", data[0] | data[1] << 8);
+
+	printf("%s: %d failure(s)\n", __FILE__, failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * test_irqstat.c
+ *
+ * Created: 2026-10-20 4:02:17 PM
+ *  Author: Tal Zaitsev
+ */
+
+/*
+ * Host test of the interrupt statistics (s2c_common/s2c_irqstat.h).
+ *
+ * Feeds simulated SysTick readings through the same code the handlers use:
+ * a down-counter from RELOAD to 0, with handlers entered and left at known
+ * counts, across the wrap too.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <s2c_irqstat.h>
+
+#define RELOAD		999 // 1000 cycles per period, like a 1 kHz tick at 1 MHz
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+		if(!(cond)) { \
+			printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+			++failures; \
+		} \
+	} while(0)
+
+/*
+ * One SysTick run the way irq_exit_tick() records it: the counter hit 0 and
+ * reloaded, the handler read entry first and exit last
+ */
+static void tick(struct s2c_irqstat *stat, uint32_t entry, uint32_t exit) {
+	s2c_irqstat_record(stat, s2c_irqstat_elapsed(0, entry, RELOAD), s2c_irqstat_elapsed(entry, exit, RELOAD));
+}
+
+static void test_elapsed(void) {
+	CHECK(s2c_irqstat_elapsed(500, 400, RELOAD) == 100, "no wrap");
+	CHECK(s2c_irqstat_elapsed(400, 400, RELOAD) == 0, "same reading");
+	CHECK(s2c_irqstat_elapsed(50, 950, RELOAD) == 100, "across the wrap: %u", s2c_irqstat_elapsed(50, 950, RELOAD));
+	CHECK(s2c_irqstat_elapsed(0, RELOAD, RELOAD) == 1, "0 to reload is one cycle");
+	CHECK(s2c_irqstat_elapsed(0, 990, RELOAD) == 10, "tick latency, 10 cycles after the reload");
+}
+
+static void test_tick(void) {
+	struct s2c_irqstat stat;
+	s2c_irqstat_reset(&stat);
+	CHECK(!s2c_irqstat_has_latency(&stat), "nothing recorded yet");
+
+	tick(&stat, RELOAD - 12, RELOAD - 112);	// 13 cycles late, 100 long
+	tick(&stat, RELOAD - 19, RELOAD - 79);	// 20 late, 60 long
+	tick(&stat, RELOAD - 15, 30);			// 16 late, runs to 30 cycles before the next tick
+	CHECK(stat.count == 3, "count %u", stat.count);
+	CHECK(s2c_irqstat_has_latency(&stat), "ticks have latency");
+	CHECK(stat.min_latency == 13, "min latency %u", stat.min_latency);
+	CHECK(stat.max_latency == 20, "max latency %u", stat.max_latency);
+	CHECK(stat.max_duration == RELOAD - 15 - 30, "max duration %u", stat.max_duration);
+
+	// A preempted run that wraps: entry 100 cycles before the reload, exit 50 after it
+	s2c_irqstat_reset(&stat);
+	tick(&stat, 100, RELOAD - 49);
+	CHECK(stat.max_duration == 150, "wrapped duration %u", stat.max_duration);
+}
+
+static void test_duration_only(void) {
+	struct s2c_irqstat stat;
+	s2c_irqstat_reset(&stat);
+
+	// ADC and CAN: entry and exit at arbitrary points of the period, no latency
+	s2c_irqstat_record_duration(&stat, s2c_irqstat_elapsed(700, 620, RELOAD));
+	s2c_irqstat_record_duration(&stat, s2c_irqstat_elapsed(20, 900, RELOAD));
+	CHECK(stat.count == 2, "count %u", stat.count);
+	CHECK(stat.max_duration == 120, "max duration %u", stat.max_duration);
+	CHECK(!s2c_irqstat_has_latency(&stat), "no latency from duration-only runs");
+	CHECK(stat.max_latency == 0, "max latency left at 0: %u", stat.max_latency);
+}
+
+int main(void) {
+	test_elapsed();
+	test_tick();
+	test_duration_only();
+
+	printf("test_irqstat.c: %d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
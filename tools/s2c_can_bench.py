@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+#
+# s2c_can_bench.py
+#
+# Created: 2026-10-20 11:04:18 AM
+#  Author: Tal Zaitsev
+#
+# Bus model for the CAN loopback benchmark (see s2c_sensor_module/src/s2c_can_bench.h),
+# and decoder for the results a sensor module measured, from a candump log.
+#
+# The model is not a run of the benchmark: it has no CPU, M_CAN or interrupt
+# in it, only the bus. It builds the frames the firmware sends in a case
+# (ID = sequence number, payload byte n = sequence + n), stuffs them and
+# times them at the nominal and data bitrates, which gives the most the bus
+# allows: frames/s back to back, and the latency of a frame queued behind
+# depth - 1 others. The measured frames/s as a share of that is the "eff %"
+# column. FD bit rate switching is taken at bit boundaries, not sample points.
+#
+# With a log the cases are the ones in it: format, payload size and TX depth
+# are decoded from each result frame. Without one the model runs the default
+# sweep, with --tx-buffers as the deepest case.
+#
+# usage: s2c_can_bench.py [--board-id <id> --log <candump log>] [--nominal <bit/s>] [--data <bit/s>]
+#                         [--fd] [--element-size <bytes>] [--tx-buffers <n>]
+#
+# Both candump output formats are accepted:
+#   (1634567890.123456) can0 7DB#0011223344556677     (candump -L)
+#   can0  7DB   [8]  00 11 22 33 44 55 66 77           (candump)
+
+import argparse
+import re
+import struct
+import sys
+
+CAN_ID_BASE = 0x700
+CAN_MSG_BENCH = 0x9
+
+# Default sweep of s2c_can_bench.h, the last depth is CONF_CAN0_TX_BUFFER_NUM
+BENCH_FORMATS = ["classic", "fd", "fd_brs"]
+BENCH_PAYLOADS = [0, 4, 8, 16, 32, 64]
+BENCH_DEPTHS = [1, 2, 4]
+BENCH_SEQUENCE_MASK = 0x7FF
+MODEL_FRAMES = 256  # frames per case, enough for every payload pattern
+
+LOG_LINE = re.compile(r"^\((\S+)\)\s+\S+\s+([0-9A-Fa-f]+)#([0-9A-Fa-f]*)")
+DUMP_LINE = re.compile(r"^\s*\S+\s+([0-9A-Fa-f]+)\s+\[\d+\]\s+((?:[0-9A-Fa-f]{2}\s*)*)$")
+
+
+def read_frames(path):
+    with open(path) as log:
+        for line in log:
+            match = LOG_LINE.match(line)
+            if match:
+                yield match.group(1), int(match.group(2), 16), bytes.fromhex(match.group(3))
+                continue
+            match = DUMP_LINE.match(line)
+            if match:
+                yield None, int(match.group(1), 16), bytes.fromhex(match.group(2).replace(" ", ""))
+
+
+def bits(value, width):
+    return [(value >> i) & 1 for i in range(width - 1, -1, -1)]
+
+
+def crc15(stream):
+    crc = 0
+    for bit in stream:
+        crc = ((crc << 1) & 0x7FFF) ^ (0x4599 if bit ^ (crc >> 14) else 0)
+    return crc
+
+
+def stuff(stream):
+    # One stuff bit after 5 equal bits, the stuff bit starts the next run
+    out = []
+    run_bit, run = None, 0
+    for bit in stream:
+        out.append(bit)
+        run = run + 1 if bit == run_bit else 1
+        run_bit = bit
+        if run == 5:
+            out.append(1 - bit)
+            run_bit, run = 1 - bit, 1
+    return out
+
+
+def dlc(payload):
+    if payload <= 8:
+        return payload
+    return 6 + payload // 4 if payload <= 24 else 11 + payload // 16
+
+
+def frame_time(can_id, data, fmt, nominal, data_rate):
+    """Seconds from start of frame to the end of the interframe space"""
+    fixed_tail = 1 + 1 + 1 + 7 + 3  # CRC delimiter, ACK, ACK delimiter, EOF, intermission
+    if fmt == "classic":
+        head = [0] + bits(can_id, 11) + [0, 0, 0] + bits(dlc(len(data)), 4)
+        head += [bit for byte in data for bit in bits(byte, 8)]
+        return (len(stuff(head + bits(crc15(head), 15))) + fixed_tail) / nominal
+
+    # FD: dynamic stuffing up to the data field, then the stuff count and CRC with fixed stuff bits
+    brs = fmt == "fd_brs"
+    arbitration = [0] + bits(can_id, 11) + [0, 0, 1, 0, int(brs)]
+    control = [0] + bits(dlc(len(data)), 4) + [bit for byte in data for bit in bits(byte, 8)]
+    stuffed = stuff(arbitration + control)
+    crc_bits = 17 if len(data) <= 16 else 21
+    fast_bits = len(stuffed) - len(arbitration) + 4 + crc_bits + (4 + crc_bits) // 4 + 1
+    slow_bits = len(arbitration) + fixed_tail
+    # Stuff bits in the arbitration part are counted as data phase bits, close enough for a few bits
+    return slow_bits / nominal + fast_bits / (data_rate if brs else nominal)
+
+
+def model_case(fmt, payload, depth, nominal, data_rate):
+    times = []
+    for sequence in range(MODEL_FRAMES):
+        data = bytes((sequence + n) & 0xFF for n in range(payload))
+        times.append(frame_time(sequence & BENCH_SEQUENCE_MASK, data, fmt, nominal, data_rate))
+    mean = sum(times) / len(times)
+    return {
+        "frames_per_s": 1 / mean,
+        "latency_us": depth * mean * 1e6,  # its own frame and depth - 1 queued ahead
+        "max_latency_us": depth * max(times) * 1e6,
+    }
+
+
+def sweep(fd, element_size, tx_buffers):
+    for fmt in BENCH_FORMATS[:3 if fd else 1]:
+        for payload in BENCH_PAYLOADS:
+            if payload > (8 if fmt == "classic" else element_size):
+                continue
+            for depth in BENCH_DEPTHS + [tx_buffers]:
+                yield fmt, payload, depth
+
+
+def read_results(path, board_id):
+    bench_id = CAN_ID_BASE + (board_id << 4) + CAN_MSG_BENCH
+    results = {}
+    for _, can_id, data in read_frames(path):
+        if can_id != bench_id or len(data) != 8:
+            continue
+        payload, header = data[0], data[1]
+        key = (BENCH_FORMATS[(header >> 4) & 0x3], payload, header & 0xF)
+        values = struct.unpack("<HHH", data[2:8])
+        fields = ("latency_us", "max_latency_us", "lost") if header & 0x40 else ("frames_per_s", "queue_cycles", "isr_cycles")
+        results.setdefault(key, {}).update(zip(fields, values))  # later sets replace earlier ones
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Bus model for the S2C CAN loopback benchmark, next to a module's results")
+    parser.add_argument("--board-id", type=int)
+    parser.add_argument("--log")
+    parser.add_argument("--nominal", type=int, default=500000, help="CONF_CAN_NOMINAL_BITRATE")
+    parser.add_argument("--data", type=int, help="CONF_CAN_DATA_BITRATE, the nominal bitrate if not given")
+    parser.add_argument("--fd", action="store_true", help="CONF_CAN_FD_ENABLE")
+    parser.add_argument("--element-size", type=int,
+                        help="CONF_CAN_ELEMENT_DATA_SIZE, 64 with --fd and 8 without if not given")
+    parser.add_argument("--tx-buffers", type=int, default=7, help="CONF_CAN0_TX_BUFFER_NUM, the deepest case")
+    args = parser.parse_args()
+    if (args.log is None) != (args.board_id is None):
+        parser.error("--log and --board-id go together")
+    data_rate = args.data or args.nominal
+
+    measured = read_results(args.log, args.board_id) if args.log else {}
+    if args.log and not measured:
+        sys.exit("no benchmark frames from board %d in %s" % (args.board_id, args.log))
+
+    print("%-8s %4s %5s | %8s %8s %8s | %8s %6s %6s %8s %8s %5s" % (
+        "format", "size", "depth", "model/s", "lat us", "max us",
+        "frames/s", "eff %", "queue", "isr", "lat us", "lost"))
+    fd = args.fd or any(key[0] != "classic" for key in measured)
+    element_size = args.element_size or (64 if fd else 8)
+    if measured:
+        cases = sorted(measured, key=lambda key: (BENCH_FORMATS.index(key[0]), key[1], key[2]))
+    else:
+        cases = sweep(fd, element_size, args.tx_buffers)
+    for fmt, payload, depth in cases:
+        model = model_case(fmt, payload, depth, args.nominal, data_rate)
+        line = "%-8s %4d %5d | %8.0f %8.0f %8.0f |" % (
+            fmt, payload, depth, model["frames_per_s"], model["latency_us"], model["max_latency_us"])
+        result = measured.get((fmt, payload, depth))
+        if result and len(result) == 6:
+            line += " %8d %6.1f %6d %8d %8d %5d" % (
+                result["frames_per_s"], 100 * result["frames_per_s"] / model["frames_per_s"],
+                result["queue_cycles"], result["isr_cycles"], result["latency_us"], result["lost"])
+        elif args.log:
+            line += " (only one of its two frames in the log)"
+        print(line)
+
+
+if __name__ == "__main__":
+    main()
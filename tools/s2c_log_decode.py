@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+#
+# s2c_log_decode.py
+#
+# Created: 2026-10-19 8:34:27 PM
+#  Author: Tal Zaitsev
+#
+# Decodes S2C deferred-format log records (see s2c_sensor_module/src/s2c_log.h)
+# from a candump log, using the format strings kept in the firmware ELF.
+#
+# usage: s2c_log_decode.py <board id> <candump log> <firmware elf>
+#
+# Both candump output formats are accepted:
+#   (1634567890.123456) can0 7DB#0011223344556677     (candump -L)
+#   can0  7DB   [8]  00 11 22 33 44 55 66 77           (candump)
+
+import argparse
+import re
+import struct
+import sys
+
+CAN_ID_BASE = 0x700
+CAN_MSG_LOG = 0xB
+LOG_ID_DROPPED = 0xFFFF
+
+LOG_LINE = re.compile(r"^\((\S+)\)\s+\S+\s+([0-9A-Fa-f]+)#([0-9A-Fa-f]*)")
+DUMP_LINE = re.compile(r"^\s*\S+\s+([0-9A-Fa-f]+)\s+\[\d+\]\s+((?:[0-9A-Fa-f]{2}\s*)*)$")
+CONVERSION = re.compile(r"%(%|[-+ #0]*\d*(?:\.\d+)?[hl]*([diouxXc]))")
+
+
+def read_frames(path):
+    with open(path) as log:
+        for line in log:
+            match = LOG_LINE.match(line)
+            if match:
+                yield match.group(1), int(match.group(2), 16), bytes.fromhex(match.group(3))
+                continue
+            match = DUMP_LINE.match(line)
+            if match:
+                yield None, int(match.group(1), 16), bytes.fromhex(match.group(2).replace(" ", ""))
+
+
+def read_strings(elf):
+    """Returns the address and contents of the ELF's .s2c_log section, None if it has none
+
+    The section is INFO, not loaded, so objcopy -O binary leaves it out: its
+    contents are read straight from the file.
+    """
+    with open(elf, "rb") as f:
+        image = f.read()
+    if image[:4] != b"\x7fELF" or image[5] != 1:
+        sys.exit("%s is not a little-endian ELF file" % elf)
+    if image[4] == 1:
+        shoff, = struct.unpack_from("<I", image, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", image, 0x2E)
+        header = lambda i: struct.unpack_from("<IIIIII", image, shoff + i * shentsize)
+    else:
+        shoff, = struct.unpack_from("<Q", image, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", image, 0x3A)
+        header = lambda i: struct.unpack_from("<IIQQQQ", image, shoff + i * shentsize)
+
+    names_offset = header(shstrndx)[4]
+    for i in range(shnum):
+        name, _, _, addr, offset, size = header(i)
+        start = names_offset + name
+        if image[start:image.index(b"\0", start)] == b".s2c_log":
+            return addr, image[offset:offset + size]
+    return None
+
+
+def format_record(table, log_id, args):
+    if log_id == LOG_ID_DROPPED:
+        return "(%d log records dropped)" % args[0]
+    if log_id >= len(table):
+        return "(unknown log id 0x%04x: %04x %04x %04x)" % ((log_id,) + args)
+    fmt = table[log_id:table.index(b"\0", log_id)].decode("ascii", "replace")
+
+    # Arguments are 16 bit on the wire, %d and %i are signed
+    values = iter(args)
+
+    def convert(match):
+        if match.group(1) == "%":
+            return "%"
+        value = next(values, 0)
+        if match.group(2) in "di":
+            value = struct.unpack("<h", struct.pack("<H", value))[0]
+        return ("%" + match.group(1).replace("h", "").replace("l", "")) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes S2C deferred-format log records")
+    parser.add_argument("board_id", type=int)
+    parser.add_argument("log")
+    parser.add_argument("elf")
+    args = parser.parse_args()
+
+    section = read_strings(args.elf)
+    if not section or not section[1]:
+        sys.exit("no .s2c_log section in %s" % args.elf)
+    base, table = section
+
+    log_id = CAN_ID_BASE + (args.board_id << 4) + CAN_MSG_LOG
+    for timestamp, can_id, data in read_frames(args.log):
+        if can_id != log_id or len(data) != 8:
+            continue
+        record = struct.unpack("<HHHH", data)
+        # A log ID is the low 16 bits of the string's address, the section is linked at 0
+        offset = record[0] if record[0] == LOG_ID_DROPPED else (record[0] - base) & 0xFFFF
+        text = format_record(table, offset, record[1:])
+        print("%s %s" % (timestamp, text) if timestamp else text)
+
+
+if __name__ == "__main__":
+    main()
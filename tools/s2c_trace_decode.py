@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#
+# s2c_trace_decode.py
+#
+# Created: 2026-10-19 7:21:14 PM
+#  Author: Tal Zaitsev
+#
+# Decodes an S2C post-mortem MTB trace dump (see s2c_sensor_module/src/s2c_trace.h)
+# from a candump log into function and source line per branch.
+#
+# usage: s2c_trace_decode.py <board id> <candump log> <firmware elf> [--addr2line <tool>]
+#
+# Both candump output formats are accepted:
+#   (1634567890.123456) can0 7D0#0011223344556677     (candump -L)
+#   can0  7D0   [8]  00 11 22 33 44 55 66 77           (candump)
+
+import argparse
+import re
+import struct
+import subprocess
+import sys
+
+CAN_ID_BASE = 0x700
+CAN_MSG_TRACE_HEADER = 0xC
+CAN_MSG_TRACE = 0xD
+
+CAUSES = {0: "none", 1: "hard fault", 2: "watchdog"}
+TRACE_FLAG_ORDER_UNKNOWN = 0x01
+TRACE_FLAG_TRACING = 0x02
+
+LOG_LINE = re.compile(r"^\(\S+\)\s+\S+\s+([0-9A-Fa-f]+)#([0-9A-Fa-f]*)")
+DUMP_LINE = re.compile(r"^\s*\S+\s+([0-9A-Fa-f]+)\s+\[\d+\]\s+((?:[0-9A-Fa-f]{2}\s*)*)$")
+
+
+def read_frames(path):
+    with open(path) as log:
+        for line in log:
+            match = LOG_LINE.match(line) or DUMP_LINE.match(line)
+            if match:
+                yield int(match.group(1), 16), bytes.fromhex(match.group(2).replace(" ", ""))
+
+
+def last_dump(frames, board_id):
+    # Keeps the last header and the data frames that follow it
+    header_id = CAN_ID_BASE + (board_id << 4) + CAN_MSG_TRACE_HEADER
+    data_id = CAN_ID_BASE + (board_id << 4) + CAN_MSG_TRACE
+    header, packets = None, []
+    for can_id, data in frames:
+        if can_id == header_id and len(data) == 8:
+            header, packets = data, []
+        elif can_id == data_id and len(data) == 8 and header is not None:
+            packets.append(struct.unpack("<II", data))
+    return header, packets
+
+
+def symbolize(addresses, elf, addr2line):
+    if not addresses:
+        return {}
+    out = subprocess.run([addr2line, "-e", elf, "-f", "-C", "-s"] + ["0x%08x" % a for a in addresses],
+                         capture_output=True, text=True, check=True).stdout.splitlines()
+    return {a: "%s (%s)" % (out[2 * i], out[2 * i + 1]) for i, a in enumerate(addresses)}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes an S2C post-mortem MTB trace dump")
+    parser.add_argument("board_id", type=int)
+    parser.add_argument("log")
+    parser.add_argument("elf")
+    parser.add_argument("--addr2line", default="arm-none-eabi-addr2line")
+    args = parser.parse_args()
+
+    header, packets = last_dump(read_frames(args.log), args.board_id)
+    if header is None:
+        sys.exit("no trace header from board %d in %s" % (args.board_id, args.log))
+
+    cause, flags, count, pc = struct.unpack("<BBHI", header)
+    if len(packets) != count:
+        print("warning: header announces %d packets, log has %d" % (count, len(packets)))
+
+    # Bit 0 of the source is the A bit (exception entry/return), bit 0 of the destination the S bit (trace start)
+    addresses = sorted({pc} | {p[0] & ~1 for p in packets} | {p[1] & ~1 for p in packets})
+    names = symbolize(addresses, args.elf, args.addr2line)
+
+    print("cause: %s" % CAUSES.get(cause, "unknown (%d)" % cause))
+    if cause != 2 or pc != 0:
+        print("faulting pc: 0x%08x %s" % (pc, names.get(pc, "")))
+    if not flags & TRACE_FLAG_TRACING:
+        print("trace was not running (USE_MTB_TRACE off)")
+    if flags & TRACE_FLAG_ORDER_UNKNOWN:
+        print("warning: trace position unknown, packets are in buffer order, not oldest first")
+
+    for i, (src, dst) in enumerate(packets):
+        marks = ("E" if src & 1 else " ") + ("S" if dst & 1 else " ")
+        print("%4d %s 0x%08x %-48s -> 0x%08x %s" % (i, marks, src & ~1, names.get(src & ~1, ""),
+                                                     dst & ~1, names.get(dst & ~1, "")))
+
+
+if __name__ == "__main__":
+    main()